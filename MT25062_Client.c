@@ -0,0 +1,789 @@
+/*
+ * MT25062_Client.c
+ * Netbench TCP Client (Sender Side)
+ * Roll No: MT25062
+ *
+ * One client for every copy strategy. The client spawns multiple
+ * threads, each connecting to the server and sending message_t
+ * instances (8 heap-allocated string fields) for 'duration' seconds.
+ * How a message reaches the socket is delegated to a send engine:
+ *
+ *   two_copy  - serialize + send()             (MT25062_Part_A1_Client.c)
+ *   one_copy  - sendmsg() with iovec           (MT25062_Part_A2_Client.c)
+ *   zero_copy - sendmsg() with MSG_ZEROCOPY    (MT25062_Part_A3_Client.c)
+ *   uring_zc  - io_uring IORING_OP_SEND_ZC     (MT25062_Part_A4_Client.c)
+ *
+ * The connection handshake, timing, latency histograms and the RESULT
+ * line are shared, so every engine is measured by the same loop. The
+ * a1..a4_client binaries are this client built with a different
+ * DEFAULT_ENGINE.
+ *
+ * Batching (-b K, two_copy and one_copy): each engine send() call
+ * carries K logical messages, so small messages stop paying one syscall
+ * each. Latency samples are then per call (per batch), and the client
+ * reports both messages/sec and send calls/sec.
+ *
+ * Placement (-P compact|scatter|cpu-list): thread i is pinned to the
+ * i-th CPU of the policy before it connects, so the socket, its buffers
+ * and the cache-miss counters stay on one core for the whole run.
+ *
+ * NUMA (-N local|remote|node): message fields and engine buffers are
+ * mbind()ed by the thread that sends them; with -P, "local" is the
+ * node of the pinned core and "remote" the next node over.
+ *
+ * Hugepages (-H): the 8 fields are carved contiguously from one 2 MiB
+ * MAP_HUGETLB arena (THP fallback) instead of 8 malloc() calls, cutting
+ * TLB misses and the page pinning cost of the zero-copy engines.
+ *
+ * Payloads (-G counter|random|record): the fields are rewritten before
+ * every send (outside the timed region), so serialization and kernel
+ * copies read freshly written, cache-cold data as a real producer's
+ * would. With zero_copy, pair it with -R so no in-flight buffer changes.
+ *
+ * Sizes (-D fixed|uniform|bimodal|zipf|trace): each message's size is
+ * drawn from a distribution capped at msg_size and split across the 8
+ * fields. Variable sizes imply framing (-F): every message is preceded
+ * by a frame_hdr_t length so the server can count whole messages.
+ *
+ * Checksums (-C): the CRC32C of each payload (SSE4.2 where available)
+ * travels in its frame header and the server verifies it, proving the
+ * zero-copy paths deliver intact bytes; the CRC time is reported apart
+ * from the send latency.
+ *
+ * Counters (-p): each thread opens perf_event_open() counters (cycles,
+ * instructions, L1D/LLC misses, context switches) enabled only around
+ * its send loop; the sums are appended to the RESULT line.
+ *
+ * Windows (-w warm-up, -c cool-down): threads connect, meet at a start
+ * barrier and share one epoch; traffic flows from the epoch to the end
+ * of the cool-down, but only the 'duration' window in between counts.
+ *
+ * Open loop (-O rate[:poisson]): sends follow a schedule of intended
+ * times at the target rate instead of back to back; latency runs from
+ * each send's intended time, so a stalled send also charges the sends
+ * queued behind it (no coordinated omission).
+ *
+ * Kernel pacing (-K rate): the same rate instead becomes each socket's
+ * SO_MAX_PACING_RATE, so TCP and the fq qdisc space the segments out
+ * while the thread sends back to back. Every run reports the threads'
+ * CPU time per byte, which compares the two pacers' cost directly.
+ *
+ * Usage: ./netbench_client [-i engine] [-e] [-t] [-p] [-w warmup] [-c cooldown]
+ *                          [-O rate] [-K rate]
+ *                          [-W window] [-R ring] [-b batch] [-P policy] [-N placement]
+ *                          [-H] [-G payload] [-D sizes] [-F] [-C]
+ *                          <server_ip> <port> <msg_size> <threads> <duration>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <math.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <errno.h>
+#include <signal.h>
+
+#include "MT25062_Netbench.h"
+
+/* ========================= Constants ================================= */
+#ifndef DEFAULT_ENGINE
+#define DEFAULT_ENGINE     "two_copy"
+#endif
+#define ZC_WINDOW_DEFAULT  128   /* Max un-notified MSG_ZEROCOPY sends */
+#define PACE_LATE_NS       10000 /* -O: a send this far past due is late */
+
+/* ========================= Send Engines ============================== */
+static const send_engine_t *const g_engines[] = {
+    &engine_two_copy,
+    &engine_one_copy,
+    &engine_zero_copy,
+    &engine_uring_zc,
+};
+#define NUM_ENGINES  (int)(sizeof(g_engines) / sizeof(g_engines[0]))
+
+/* find_engine - Looks up a send engine by name, NULL if unknown */
+static const send_engine_t *find_engine(const char *name) {
+    for (int i = 0; i < NUM_ENGINES; i++)
+        if (strcmp(g_engines[i]->name, name) == 0) return g_engines[i];
+    return NULL;
+}
+
+/* ========================= Structures ================================ */
+
+/* Thread arguments with input params and output metrics */
+typedef struct {
+    int       thread_id;
+    char      server_ip[64];
+    int       server_port;
+    int       msg_size;
+    int       duration;
+    uint64_t  warmup_ns;        /* -w: unmeasured lead-in            */
+    uint64_t  cooldown_ns;      /* -c: unmeasured tail               */
+    int       echo;
+    int       zc_window;
+    int       zc_ring;
+    int       batch;
+    int       cpu;              /* -P placement, -1 = unpinned       */
+    payload_mode_t payload;     /* -G generator                      */
+    int       framed;           /* -F / -D: frame_hdr_t per message  */
+    int       checksum;         /* -C: CRC32C in every frame header  */
+    const size_dist_t *sizes;   /* -D distribution                   */
+    const pace_spec_t *pace;    /* -O open-loop rate, NULL = closed  */
+    int       threads;          /* -O: the rate is split this many ways */
+    double    kernel_rate;      /* -K: SO_MAX_PACING_RATE, bytes/sec */
+    const send_engine_t *engine;
+    long long bytes_transferred;
+    long long msgs_sent;        /* logical messages (calls * batch)  */
+    long long send_calls;       /* engine send() calls               */
+    double    elapsed_time;
+    double    avg_latency_us;
+    uint64_t  total_lat_ns;     /* sum of per-call latencies         */
+    uint64_t  service_ns;       /* -O: sum of actual-start latencies */
+    long long late_sends;       /* -O: started PACE_LATE_NS past due */
+    uint64_t  window_start_ns;  /* counted span, shared time base    */
+    uint64_t  window_stop_ns;
+    uint64_t  cpu_ns;           /* thread CPU time over the window   */
+    latency_hist_t hist;        /* per-thread send latency histogram */
+    send_stats_t   stats;       /* zero-copy completion counters     */
+    int       counters;         /* -p: perf_event counters requested */
+    int       perf_opened;      /* -p: counters actually opened      */
+    int       perf_hw;          /* -p: PMU (cycles) counter opened   */
+    perf_counters_t perf;       /* -p: send-loop counter values      */
+    uint64_t  crc_ns;           /* -C: time spent computing CRCs     */
+    long long crc_bytes;        /* -C: payload bytes checksummed     */
+} thread_args_t;
+
+/* ========================= Start Barrier ============================ */
+/*
+ * Every thread connects and sets up before any sends, then all leave
+ * the barrier together and measure against one shared epoch, so the
+ * warm-up and measurement windows line up across threads.
+ */
+static pthread_barrier_t g_start_barrier;
+static uint64_t          g_epoch_ns;
+
+/*
+ * sync_start - Waits until all threads are ready. The barrier's serial
+ * thread reads the clock once; a second wait publishes it to the rest.
+ * Threads that failed to set up still call this to release the others.
+ * Returns: the shared epoch (timer_now_ns() time base).
+ */
+static uint64_t sync_start(void) {
+    if (pthread_barrier_wait(&g_start_barrier) == PTHREAD_BARRIER_SERIAL_THREAD)
+        g_epoch_ns = timer_now_ns();
+    pthread_barrier_wait(&g_start_barrier);
+    return g_epoch_ns;
+}
+
+/* ========================= Client Thread ============================ */
+/*
+ * client_thread - Thread function for sending data to server.
+ *
+ * Each thread independently:
+ *   1. Pins itself (-P) and connects to the server.
+ *   2. Allocates a message_t with 8 heap-allocated fields and opens
+ *      the send engine on the socket.
+ *   3. Sends configuration (msg_size, duration, echo).
+ *   4. Waits at the start barrier, then sends messages through the
+ *      engine for warm-up + 'duration' + cool-down seconds, writing
+ *      each into the buffer the engine's acquire() hands out. Only
+ *      messages sent wholly inside the 'duration' window are counted.
+ *   5. Closes the engine (draining completions) and records metrics.
+ *
+ * In echo mode each send is followed by receiving the server's copy of
+ * the message, so the recorded latency is the full round-trip time.
+ */
+static void *client_thread(void *arg) {
+    thread_args_t       *targs = (thread_args_t *)arg;
+    const send_engine_t *eng   = targs->engine;
+
+    /* --- Step 1: Pin, then connect to server --- */
+    pin_thread_to_cpu(targs->cpu);
+    int sock = connect_to_server(targs->server_ip, targs->server_port);
+    if (sock < 0) {
+        fprintf(stderr, "[Client T%d] Connection failed\n", targs->thread_id);
+        sync_start();
+        return NULL;
+    }
+    if (targs->echo) {
+        /* Ping-pong: don't let Nagle hold back a message's last segment */
+        int one = 1;
+        setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    if (targs->kernel_rate > 0 && socket_set_pacing(sock, targs->kernel_rate) < 0)
+        perror("setsockopt SO_MAX_PACING_RATE");
+
+    /* --- Step 2: Allocate message and open the send engine --- */
+    message_t  *msg  = alloc_message(targs->msg_size);
+    send_opts_t opts = {
+        .thread_id = targs->thread_id,
+        .msg_size  = targs->msg_size,
+        .zc_window = targs->zc_window,
+        .zc_ring   = targs->zc_ring,
+        .batch     = targs->batch,
+    };
+    void *ctx = eng->open(sock, msg, &opts);
+    if (!ctx) {
+        free_message(msg);
+        close(sock);
+        sync_start();
+        return NULL;
+    }
+
+    /* --- Step 3: Send configuration to server --- */
+    config_t config;
+    config.msg_size = targs->msg_size;
+    config.duration = targs->duration;
+    config.echo     = targs->echo;
+    config.framed   = targs->framed;
+    config.checksum = targs->checksum;
+    if (send(sock, &config, sizeof(config), 0) != sizeof(config)) {
+        fprintf(stderr, "[Client T%d] Failed to send config\n", targs->thread_id);
+        eng->close(ctx, sock, &targs->stats);
+        free_message(msg);
+        close(sock);
+        sync_start();
+        return NULL;
+    }
+
+    /* Echo replies land here (echo mode only) */
+    char *echo_buf = NULL;
+    size_t echo_len = ((size_t)targs->msg_size + sizeof(frame_hdr_t)) * targs->batch;
+    if (targs->echo && !(echo_buf = (char *)malloc(echo_len))) {
+        perror("malloc echo_buf");
+        targs->echo = 0;
+    }
+
+    payload_gen_t gen;
+    size_gen_t    sizes;
+    payload_init(&gen, targs->payload, (uint64_t)targs->thread_id + 1);
+    size_gen_init(&sizes, targs->sizes, targs->msg_size, (uint64_t)targs->thread_id + 1);
+
+    /* --- Step 4: Send loop: warm-up, 'duration' window, cool-down --- */
+    if (targs->counters) targs->perf_opened = perf_counters_open(&targs->perf);
+    uint64_t  epoch_ns      = sync_start();
+    uint64_t  measure_ns    = epoch_ns + targs->warmup_ns;
+    uint64_t  measure_end   = measure_ns + (uint64_t)targs->duration * 1000000000ULL;
+    uint64_t  deadline_ns   = measure_end + targs->cooldown_ns;
+    uint64_t  now_ns        = epoch_ns;
+    uint64_t  stop_ns       = measure_ns;   /* end of the counted span */
+    uint64_t  cpu_start     = 0;
+    int       measuring     = 0;
+    pacer_t   pacer;
+    if (targs->pace)
+        pacer_init(&pacer, targs->pace, targs->threads, epoch_ns, (uint64_t)targs->thread_id + 1);
+    long long total_bytes   = 0;
+    long long msg_count     = 0;
+    long long send_calls    = 0;
+    uint64_t  total_lat_ns  = 0;
+    uint32_t  seq           = 0;
+
+    /*
+     * The deadline is compared against the end timestamp each message
+     * already takes for its latency sample, so the loop condition itself
+     * costs no clock read.
+     */
+    while (now_ns < deadline_ns) {
+        /*
+         * Count only messages that start and end inside the window;
+         * counters (-p) run exactly while messages are being counted,
+         * so neither setup nor first-touch faults are included.
+         */
+        int in_window = now_ns >= measure_ns && now_ns < measure_end;
+        if (in_window != measuring) {
+            measuring = in_window;
+            if (measuring) {
+                cpu_start = thread_cpu_ns();
+            } else {
+                stop_ns       = measure_end;
+                targs->cpu_ns = thread_cpu_ns() - cpu_start;
+            }
+            if (targs->counters) {
+                if (measuring) perf_counters_start(&targs->perf);
+                else           perf_counters_stop(&targs->perf);
+            }
+        }
+
+        /* Untimed per-message work (e.g. A1's serialization copy) */
+        message_t *cur = eng->acquire ? eng->acquire(ctx, sock, msg) : msg;
+        if (!cur) {
+            if (errno != EPIPE && errno != ECONNRESET)
+                fprintf(stderr, "[Client T%d] %s: %s\n",
+                        targs->thread_id, eng->name, strerror(errno));
+            break;
+        }
+        cur->framed = targs->framed;
+        if (targs->sizes->mode != SIZE_FIXED) message_set_size(cur, size_gen_next(&sizes));
+        if (gen.mode != PAYLOAD_STATIC) payload_fill(&gen, cur);
+        uint64_t due_ns = targs->pace ? pacer_next(&pacer, message_wire_len(cur) * targs->batch,
+                                                   targs->batch) : 0;
+        if (targs->checksum) {
+            uint64_t crc_start = timer_now_ns();
+            cur->hdr.crc = message_checksum(cur);
+            if (measuring) {
+                targs->crc_ns    += timer_now_ns() - crc_start;
+                targs->crc_bytes += cur->len;
+            }
+        }
+        if (cur->framed) {
+            /* Batching engines number the k-th copy seq + k */
+            cur->hdr.seq   = seq;
+            cur->hdr.ts_ns = targs->pace ? due_ns : clock_now_ns();
+            seq           += (uint32_t)targs->batch;
+        }
+        if (eng->prepare) eng->prepare(ctx, sock, cur);
+
+        if (targs->pace) pace_wait(due_ns);
+
+        uint64_t msg_start = timer_now_ns();
+        ssize_t  sent      = eng->send(ctx, sock, cur);
+        if (sent > 0 && targs->echo)
+            sent = recv_all(sock, echo_buf, sent);
+        uint64_t msg_end   = timer_now_ns();
+        now_ns = msg_end;
+
+        if (sent < 0) {
+            if (errno != EPIPE && errno != ECONNRESET)
+                fprintf(stderr, "[Client T%d] %s: %s\n",
+                        targs->thread_id, eng->name, strerror(errno));
+            break;
+        }
+        if (!measuring || msg_end > measure_end) continue;
+
+        /* Open loop: latency runs from the intended start (see -O) */
+        uint64_t lat_ns = msg_end - msg_start;
+        if (targs->pace) {
+            targs->service_ns += lat_ns;
+            if (msg_start > due_ns + PACE_LATE_NS) targs->late_sends++;
+            lat_ns = msg_end - due_ns;
+        }
+        total_bytes   += sent;
+        msg_count     += targs->batch;
+        send_calls    += 1;
+        total_lat_ns  += lat_ns;
+        hist_record(&targs->hist, lat_ns);
+    }
+
+    /* --- Step 5: Drain the engine and record metrics --- */
+    if (measuring) {
+        /* Left early (error) or no cool-down: the window ends here */
+        stop_ns       = now_ns < measure_end ? now_ns : measure_end;
+        targs->cpu_ns = thread_cpu_ns() - cpu_start;
+        if (targs->counters) perf_counters_stop(&targs->perf);
+    }
+    if (targs->counters) {
+        targs->perf_hw = targs->perf.fd[PERF_EV_CYCLES] >= 0;
+        perf_counters_close(&targs->perf);
+    }
+    eng->close(ctx, sock, &targs->stats);
+
+    double elapsed = (stop_ns - measure_ns) / 1e9;
+
+    targs->bytes_transferred = total_bytes;
+    targs->elapsed_time      = elapsed;
+    targs->msgs_sent         = msg_count;
+    targs->send_calls        = send_calls;
+    targs->avg_latency_us    = (send_calls > 0) ? (total_lat_ns / 1e3 / send_calls) : 0.0;
+    targs->total_lat_ns      = total_lat_ns;
+    targs->window_start_ns   = measure_ns;
+    targs->window_stop_ns    = stop_ns;
+
+    if (eng->zerocopy)
+        printf("[Client T%d] Sent %lld bytes in %.2f sec (%lld msgs, avg_lat=%.2f us, "
+               "zc_copied=%lld/%lld, window_waits=%lld, enobufs=%lld)\n",
+               targs->thread_id, total_bytes, elapsed, msg_count,
+               targs->avg_latency_us, targs->stats.zc_copied,
+               targs->stats.zc_completed, targs->stats.zc_window_waits,
+               targs->stats.zc_enobufs);
+    else
+        printf("[Client T%d] Sent %lld bytes in %.2f sec (%lld msgs, avg_lat=%.2f us)\n",
+               targs->thread_id, total_bytes, elapsed, msg_count,
+               targs->avg_latency_us);
+
+    free(echo_buf);
+    free_message(msg);
+    close(sock);
+    return NULL;
+}
+
+/* ========================= Fairness ================================== */
+/*
+ * print_fairness - Spread of bytes sent across threads: min, max, mean,
+ * standard deviation (and as a share of the mean) and Jain's index,
+ * (sum x)^2 / (n * sum x^2), which is 1 when all threads sent the same
+ * and 1/n when one thread sent everything. Failed threads count as 0.
+ */
+static void print_fairness(const thread_args_t *targs, int threads) {
+    double sum = 0.0, sum_sq = 0.0;
+    double lo  = (double)targs[0].bytes_transferred, hi = lo;
+    for (int i = 0; i < threads; i++) {
+        double x = (double)targs[i].bytes_transferred;
+        sum    += x;
+        sum_sq += x * x;
+        if (x < lo) lo = x;
+        if (x > hi) hi = x;
+    }
+    double mean   = sum / threads;
+    double var    = sum_sq / threads - mean * mean;
+    double stddev = var > 0 ? sqrt(var) : 0.0;
+    double jain   = sum_sq > 0 ? sum * sum / (threads * sum_sq) : 0.0;
+    printf("[Client] Fairness: MB/thread min %.1f, max %.1f, mean %.1f, "
+           "stddev %.1f (%.1f%%), Jain index %.4f\n",
+           lo / 1e6, hi / 1e6, mean / 1e6, stddev / 1e6,
+           mean > 0 ? 100.0 * stddev / mean : 0.0, jain);
+}
+
+/* ========================= Usage ===================================== */
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [-i engine] [-e] [-t] [-p] [-w warmup] [-c cooldown] [-O rate] [-K rate] "
+            "[-W window] [-R ring] [-b batch] [-P policy] [-N placement] [-H] "
+            "[-G payload] [-D sizes] [-F] [-C] "
+            "<server_ip> <port> <msg_size> <threads> <duration>\n"
+            "  -i  send engine: two_copy|one_copy|zero_copy|uring_zc (default: %s)\n"
+            "  -e  echo mode: server returns each message, latency is RTT\n"
+            "  -t  time the send loop with the calibrated TSC\n"
+            "  -w  warm-up seconds before the measured window (default: 0)\n"
+            "  -c  cool-down seconds after it; traffic flows but is not counted\n"
+            "  -O  open loop at RATE msgs/sec or RATEg Gbit/s (all threads),\n"
+            "      RATE[g][:const|:poisson]; latency from intended send time\n"
+            "  -K  kernel pacing: RATE[g] as each socket's SO_MAX_PACING_RATE\n"
+            "      (use with the fq qdisc); excludes -O\n"
+            "  -p  count cycles, instructions, cache misses and context switches\n"
+            "      over the send loop (perf_event_open); adds RESULT columns\n"
+            "  -W  max in-flight MSG_ZEROCOPY sends per thread (default: %d)\n"
+            "  -R  zero_copy/uring_zc: rotate over N message buffers, reusing one only\n"
+            "      after its completion (default: resend one buffer)\n"
+            "  -b  messages coalesced per send call, 1..%d (two_copy/one_copy)\n"
+            "  -P  pin threads: compact, scatter or a CPU list (e.g. 0,2,4-7)\n"
+            "  -N  place message buffers: local, remote or a node id (mbind)\n"
+            "  -H  carve message fields from a 2 MiB hugepage arena\n"
+            "  -G  payload generator: static|counter|random|record (default: static)\n"
+            "  -D  message sizes: fixed|uniform:MIN-MAX|bimodal:S,L,PCT|\n"
+            "      zipf:MIN-MAX[,A]|trace:FILE (capped at msg_size; implies -F)\n"
+            "  -F  length-prefixed framing, so the server counts messages\n"
+            "  -C  CRC32C of every payload, verified by the server (implies -F)\n",
+            prog, DEFAULT_ENGINE, ZC_WINDOW_DEFAULT, BATCH_MAX);
+}
+
+/* ========================= Main ====================================== */
+int main(int argc, char *argv[]) {
+    const send_engine_t *engine    = find_engine(DEFAULT_ENGINE);
+    int                  zc_window = ZC_WINDOW_DEFAULT;
+    int                  zc_ring   = 0;
+    payload_mode_t       payload   = PAYLOAD_STATIC;
+    int                  framed    = 0;
+    int                  checksum  = 0;
+    int                  counters  = 0;
+    static size_dist_t   sizes;
+    int                  batch     = 1;
+    int                  use_tsc   = 0;
+    int                  echo      = 0;
+    double               warmup    = 0.0;
+    double               cooldown  = 0.0;
+    static pace_spec_t   pace;
+    int                  open_loop = 0;
+    static pace_spec_t   kpace;
+    int                  kernel_pace = 0;
+    int                  opt;
+    static cpu_policy_t  pin;
+
+    while ((opt = getopt(argc, argv, "i:etw:c:W:R:b:P:N:HG:D:FCpO:K:")) != -1) {
+        switch (opt) {
+        case 'i': engine    = find_engine(optarg); break;
+        case 'e': echo      = 1;                   break;
+        case 't': use_tsc   = 1;                   break;
+        case 'p': counters  = 1;                   break;
+        case 'w': warmup    = atof(optarg);        break;
+        case 'c': cooldown  = atof(optarg);        break;
+        case 'O':
+            if (pace_parse(&pace, optarg) < 0) {
+                fprintf(stderr, "[Client] Bad -O rate: %s\n", optarg);
+                return EXIT_FAILURE;
+            }
+            open_loop = 1;
+            break;
+        case 'K':
+            if (pace_parse(&kpace, optarg) < 0 || kpace.arrival != ARRIVAL_CONST) {
+                fprintf(stderr, "[Client] Bad -K rate: %s\n", optarg);
+                return EXIT_FAILURE;
+            }
+            kernel_pace = 1;
+            break;
+        case 'W': zc_window = atoi(optarg);        break;
+        case 'R': zc_ring   = atoi(optarg);        break;
+        case 'b': batch     = atoi(optarg);        break;
+        case 'P':
+            if (cpu_policy_parse(&pin, optarg) < 0) {
+                fprintf(stderr, "[Client] Bad -P policy: %s\n", optarg);
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'N':
+            if (numa_policy_parse(&g_numa, optarg) < 0) {
+                fprintf(stderr, "[Client] Bad -N placement: %s\n", optarg);
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'H': g_hugepages = 1;                 break;
+        case 'F': framed = 1;                      break;
+        case 'C': checksum = framed = 1;           break;
+        case 'D':
+            if (size_dist_parse(&sizes, optarg) < 0) {
+                fprintf(stderr, "[Client] Bad -D distribution: %s\n", optarg);
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'G':
+            if (payload_parse(&payload, optarg) < 0) {
+                fprintf(stderr, "[Client] Unknown -G payload: %s\n", optarg);
+                return EXIT_FAILURE;
+            }
+            break;
+        default:  argc = 0;                        break;
+        }
+    }
+    if (argc - optind < 5 || !engine || zc_window <= 0 || zc_ring < 0 ||
+        batch < 1 || batch > BATCH_MAX || warmup < 0 || cooldown < 0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (open_loop && kernel_pace) {
+        fprintf(stderr, "[Client] -O and -K are two pacers; choose one\n");
+        return EXIT_FAILURE;
+    }
+    if (batch > 1 && !engine->batching) {
+        fprintf(stderr, "[Client] Engine %s does not support -b\n", engine->name);
+        return EXIT_FAILURE;
+    }
+    if (zc_ring > 0 && !engine->acquire) {
+        fprintf(stderr, "[Client] Engine %s does not support -R\n", engine->name);
+        return EXIT_FAILURE;
+    }
+    if (sizes.mode != SIZE_FIXED) framed = 1;
+    /* The frame header lives in the message and changes every message */
+    if (framed && !engine->hdr_copied && zc_ring == 0) {
+        fprintf(stderr, "[Client] %s needs -R with -F/-C/-D so in-flight headers "
+                "are never rewritten\n", engine->name);
+        return EXIT_FAILURE;
+    }
+    /* Regenerating one buffer would rewrite pages in-flight sends still reference */
+    if (payload != PAYLOAD_STATIC && engine->zerocopy && zc_ring == 0) {
+        fprintf(stderr, "[Client] %s needs -R with -G so in-flight buffers are "
+                "never rewritten\n", engine->name);
+        return EXIT_FAILURE;
+    }
+
+    char      **args      = argv + optind;
+    const char *server_ip = args[0];
+    int         port      = atoi(args[1]);
+    int         msg_size  = atoi(args[2]);
+    int         threads   = atoi(args[3]);
+    int         duration  = atoi(args[4]);
+
+    printf("[Client] %s Implementation\n", engine->title);
+    printf("[Client] Server=%s:%d, MsgSize=%d, Threads=%d, Duration=%d sec\n",
+           server_ip, port, msg_size, threads, duration);
+    if (echo) printf("[Client] Echo mode: latency is round-trip time\n");
+    if (open_loop) pace_describe(&pace, threads);
+    /* A msgs/sec rate becomes bytes/sec at the mean, not the capped, size */
+    double wire_mean   = size_dist_mean(&sizes, msg_size) + (framed ? sizeof(frame_hdr_t) : 0);
+    double kernel_rate = kernel_pace ? pace_kernel_rate(&kpace, wire_mean, threads) : 0.0;
+    if (kernel_pace)
+        printf("[Client] Kernel pacing: SO_MAX_PACING_RATE %.3f Gbit/s per connection "
+               "(%.3f total), enforced by TCP and fq\n",
+               kernel_rate * 8 / 1e9, kernel_rate * 8 * threads / 1e9);
+    if (warmup > 0 || cooldown > 0)
+        printf("[Client] Windows: %.2f s warm-up, %d s measured, %.2f s cool-down "
+               "(traffic flows in all three)\n", warmup, duration, cooldown);
+    if (batch > 1) printf("[Client] Batching %d messages per send call\n", batch);
+    if (framed) printf("[Client] Framing: %zu-byte header (length, seq, send time) "
+                       "per message\n",
+                       sizeof(frame_hdr_t));
+    if (checksum) printf("[Client] Checksum: CRC32C (%s) of every payload, "
+                         "verified by the server\n", crc32c_impl());
+    size_dist_describe(&sizes, msg_size);
+    if (payload != PAYLOAD_STATIC) {
+        printf("[Client] Payload: %s, regenerated before every send\n",
+               payload_name(payload));
+    }
+
+    if (use_tsc && timer_calibrate_tsc() < 0)
+        fprintf(stderr, "[Client] Invariant TSC unavailable, using CLOCK_MONOTONIC_RAW\n");
+    timer_describe();
+    cpu_policy_describe(&pin, "Client");
+    numa_policy_describe(&g_numa, "Client");
+
+    signal(SIGPIPE, SIG_IGN);
+
+    pthread_t     *tids  = malloc(sizeof(pthread_t) * threads);
+    thread_args_t *targs = calloc(threads, sizeof(thread_args_t));
+    if (!tids || !targs) { perror("malloc threads"); return EXIT_FAILURE; }
+    if (pthread_barrier_init(&g_start_barrier, NULL, threads) != 0) {
+        perror("pthread_barrier_init");
+        return EXIT_FAILURE;
+    }
+
+    /* Spawn client threads */
+    for (int i = 0; i < threads; i++) {
+        targs[i].thread_id = i;
+        strncpy(targs[i].server_ip, server_ip, sizeof(targs[i].server_ip) - 1);
+        targs[i].server_ip[sizeof(targs[i].server_ip) - 1] = '\0';
+        targs[i].server_port = port;
+        targs[i].msg_size    = msg_size;
+        targs[i].duration    = duration;
+        targs[i].warmup_ns   = (uint64_t)(warmup * 1e9);
+        targs[i].cooldown_ns = (uint64_t)(cooldown * 1e9);
+        targs[i].echo        = echo;
+        targs[i].zc_window   = zc_window;
+        targs[i].zc_ring     = zc_ring;
+        targs[i].batch       = batch;
+        targs[i].cpu         = cpu_policy_cpu(&pin, i);
+        targs[i].payload     = payload;
+        targs[i].framed      = framed;
+        targs[i].checksum    = checksum;
+        targs[i].counters    = counters;
+        targs[i].sizes       = &sizes;
+        targs[i].pace        = open_loop ? &pace : NULL;
+        targs[i].threads     = threads;
+        targs[i].kernel_rate = kernel_rate;
+        targs[i].engine      = engine;
+
+        if (pthread_create(&tids[i], NULL, client_thread, &targs[i]) != 0) {
+            perror("pthread_create");
+            return EXIT_FAILURE;
+        }
+    }
+
+    /* Wait for all threads */
+    for (int i = 0; i < threads; i++) {
+        pthread_join(tids[i], NULL);
+    }
+
+    /* Aggregate and print results */
+    long long    total_bytes   = 0;
+    long long    total_msgs    = 0;
+    long long    total_calls   = 0;
+    uint64_t     total_lat_ns  = 0;
+    uint64_t     service_ns    = 0;
+    long long    late_sends    = 0;
+    uint64_t     window_start  = UINT64_MAX;
+    uint64_t     window_stop   = 0;
+    double       thread_time   = 0.0;
+    uint64_t     cpu_ns        = 0;
+    uint64_t     crc_ns        = 0;
+    long long    crc_bytes     = 0;
+    int          perf_opened   = 0;
+    int          perf_user     = 0;
+    int          perf_hw       = 0;
+    perf_counters_t perf;
+    memset(&perf, 0, sizeof(perf));
+    send_stats_t zc;
+    memset(&zc, 0, sizeof(zc));
+    latency_hist_t *merged = calloc(1, sizeof(latency_hist_t));
+    if (!merged) { perror("calloc histogram"); return EXIT_FAILURE; }
+
+    for (int i = 0; i < threads; i++) {
+        total_bytes        += targs[i].bytes_transferred;
+        total_msgs         += targs[i].msgs_sent;
+        total_calls        += targs[i].send_calls;
+        total_lat_ns       += targs[i].total_lat_ns;
+        service_ns         += targs[i].service_ns;
+        late_sends         += targs[i].late_sends;
+        zc.zc_completed    += targs[i].stats.zc_completed;
+        zc.zc_copied       += targs[i].stats.zc_copied;
+        zc.zc_window_waits += targs[i].stats.zc_window_waits;
+        zc.zc_enobufs      += targs[i].stats.zc_enobufs;
+        zc.zc_ring_stalls  += targs[i].stats.zc_ring_stalls;
+        thread_time        += targs[i].elapsed_time;
+        cpu_ns             += targs[i].cpu_ns;
+        crc_ns             += targs[i].crc_ns;
+        crc_bytes          += targs[i].crc_bytes;
+        for (int ev = 0; ev < PERF_EV_COUNT; ev++)
+            perf.value[ev] += targs[i].perf.value[ev];
+        if (targs[i].perf_opened > perf_opened) perf_opened = targs[i].perf_opened;
+        perf_user          |= targs[i].perf.user_only;
+        perf_hw            |= targs[i].perf_hw;
+        hist_merge(merged, &targs[i].hist);
+        if (targs[i].window_stop_ns > targs[i].window_start_ns) {
+            if (targs[i].window_start_ns < window_start) window_start = targs[i].window_start_ns;
+            if (targs[i].window_stop_ns  > window_stop)  window_stop  = targs[i].window_stop_ns;
+        }
+    }
+
+    /*
+     * Aggregate rates use the global window, from the shared start to
+     * the last thread's end, not any one thread's elapsed time. Mean
+     * latency weights every send call equally rather than every thread.
+     */
+    double elapsed     = window_stop > window_start ? (window_stop - window_start) / 1e9 : 0.0;
+    double avg_latency = total_calls > 0 ? total_lat_ns / 1e3 / total_calls : 0.0;
+
+    if (engine->zerocopy)
+        printf("[Client] Zero-copy completions=%lld, copied fallback=%lld (%.2f%%), "
+               "window_waits=%lld, enobufs=%lld\n",
+               zc.zc_completed, zc.zc_copied,
+               zc.zc_completed ? 100.0 * zc.zc_copied / zc.zc_completed : 0.0,
+               zc.zc_window_waits, zc.zc_enobufs);
+    if (zc_ring > 0)
+        printf("[Client] Rotating ring: %d buffers/thread, %lld stalls waiting for a free buffer\n",
+               zc_ring, zc.zc_ring_stalls);
+
+    if (elapsed > 0)
+        printf("[Client] Rate: %.0f msgs/sec, %.0f syscalls/sec (batch=%d)\n",
+               total_msgs / elapsed, total_calls / elapsed, batch);
+    if (open_loop && elapsed > 0 && total_calls > 0)
+        printf("[Client] Open loop: achieved %.0f msgs/sec (%.3f Gbit/s), %.2f%% of sends "
+               "started >%d us late; mean latency %.2f us from intended start, "
+               "%.2f us from actual start\n",
+               total_msgs / elapsed, total_bytes * 8.0 / (elapsed * 1e9),
+               100.0 * late_sends / total_calls, PACE_LATE_NS / 1000,
+               avg_latency, service_ns / 1e3 / total_calls);
+    /* Sleeping and blocking cost nothing here; spinning costs all of it */
+    if (total_bytes > 0 && thread_time > 0)
+        printf("[Client] CPU: %.4f ns/byte sent, %.1f%% of a core per thread "
+               "(thread CPU time over the window, syscalls included)\n",
+               (double)cpu_ns / total_bytes, 100.0 * cpu_ns / 1e9 / thread_time);
+    if (threads > 1)
+        print_fairness(targs, threads);
+    if (sizes.mode != SIZE_FIXED && total_msgs > 0)
+        printf("[Client] Mean message size on the wire: %.0f bytes\n",
+               (double)total_bytes / total_msgs);
+    if (checksum && total_calls > 0 && crc_ns > 0 && thread_time > 0)
+        printf("[Client] Checksum cost: %.2f GB/s, %.0f ns/checksum, %.2f%% of thread time\n",
+               crc_bytes / (double)crc_ns, (double)crc_ns / total_calls,
+               100.0 * crc_ns / 1e9 / thread_time);
+
+    if (counters && perf_opened == 0)
+        fprintf(stderr, "[Client] perf_event_open unavailable; counter columns are 0\n");
+    else if (counters && !perf_hw)
+        fprintf(stderr, "[Client] No hardware PMU counters (e.g. in a VM); "
+                "only context switches are counted\n");
+    if (counters && perf_hw && total_bytes > 0)
+        printf("[Client] Counters (send loop%s): %.3f cycles/byte, IPC %.2f, "
+               "%.2f L1D and %.2f LLC misses/KB, %llu context switches\n",
+               perf_user ? ", user mode only" : "",
+               (double)perf.value[PERF_EV_CYCLES] / total_bytes,
+               perf.value[PERF_EV_CYCLES] ?
+                   (double)perf.value[PERF_EV_INSTRUCTIONS] / perf.value[PERF_EV_CYCLES] : 0.0,
+               perf.value[PERF_EV_L1D_MISSES] * 1024.0 / total_bytes,
+               perf.value[PERF_EV_LLC_MISSES] * 1024.0 / total_bytes,
+               (unsigned long long)perf.value[PERF_EV_CTX_SWITCHES]);
+
+    char impl[64];
+    snprintf(impl, sizeof(impl), "%s%s", engine->name, echo ? "_echo" : "");
+
+    print_results(impl, msg_size, threads, total_bytes, elapsed,
+                  avg_latency, merged, counters ? &perf : NULL);
+
+    free(merged);
+
+    free(tids);
+    free(targs);
+    return 0;
+}
@@ -0,0 +1,1333 @@
+/*
+ * MT25062_Netbench.c
+ * Netbench Core Library (shared by client and server)
+ * Roll No: MT25062
+ *
+ * Out-of-line parts of the core: TSC calibration, histogram reporting,
+ * perf_event counters, NUMA placement, message allocation, payload
+ * generators, checksums, size distributions, open-loop and kernel
+ * pacing, socket helpers, the RESULT line, CPU pinning policies and the
+ * io_uring ring wrapper. See MT25062_Netbench.h for the engine
+ * interfaces.
+ */
+
+#define _GNU_SOURCE             /* sched_getaffinity, pthread_setaffinity_np */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/socket.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <linux/mempolicy.h>
+#include <linux/perf_event.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <math.h>
+#if defined(__x86_64__)
+#include <cpuid.h>
+#endif
+
+#include "MT25062_Netbench.h"
+
+/* ========================= Timing Utilities ========================== */
+int      g_tsc_enabled = 0;
+uint64_t g_tsc_base;
+uint64_t g_tsc_ns_base;
+uint64_t g_tsc_mult;
+
+/*
+ * timer_calibrate_tsc - Enables the TSC fast path if the CPU reports an
+ * invariant TSC (CPUID 0x80000007 EDX bit 8).
+ * Returns: 0 if enabled, -1 if the raw clock remains in use.
+ */
+int timer_calibrate_tsc(void) {
+#if defined(__x86_64__)
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) || !(edx & (1u << 8)))
+        return -1;
+
+    struct timespec nap = { 0, 20 * 1000 * 1000 };
+    uint64_t t0 = tsc_read(), n0 = clock_now_ns();
+    nanosleep(&nap, NULL);
+    uint64_t t1 = tsc_read(), n1 = clock_now_ns();
+    if (t1 <= t0) return -1;
+
+    g_tsc_mult    = (uint64_t)(((unsigned __int128)(n1 - n0) << 32) / (t1 - t0));
+    g_tsc_base    = t1;
+    g_tsc_ns_base = n1;
+    g_tsc_enabled = 1;
+    return 0;
+#else
+    return -1;
+#endif
+}
+
+/* timer_describe - Prints which clock source the send loop uses */
+void timer_describe(void) {
+    if (g_tsc_enabled)
+        printf("[Client] Timer: TSC (rdtscp, %.3f GHz calibrated)\n",
+               4294967296.0 / (double)g_tsc_mult);
+    else
+        printf("[Client] Timer: CLOCK_MONOTONIC_RAW\n");
+}
+
+/* ========================= Latency Histogram ========================= */
+
+/* hist_upper - Highest value that maps to bucket 'idx' */
+static unsigned long long hist_upper(int idx) {
+    if (idx < (1 << HIST_SUB_BITS)) return (unsigned long long)idx;
+    int shift = idx / HIST_HALF - 1;
+    unsigned long long sub = (unsigned long long)(idx - shift * HIST_HALF);
+    return ((sub + 1) << shift) - 1;
+}
+
+/* hist_merge - Adds all samples of 'src' into 'dst' */
+void hist_merge(latency_hist_t *dst, const latency_hist_t *src) {
+    for (int i = 0; i < HIST_BUCKETS; i++) dst->counts[i] += src->counts[i];
+    dst->total += src->total;
+    if (src->max_ns > dst->max_ns) dst->max_ns = src->max_ns;
+}
+
+/* hist_percentile_us - Value at percentile p (0-100), in microseconds */
+double hist_percentile_us(const latency_hist_t *h, double p) {
+    if (h->total == 0) return 0.0;
+    unsigned long long rank = (unsigned long long)(p / 100.0 * h->total + 0.5);
+    if (rank < 1) rank = 1;
+
+    unsigned long long seen = 0;
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        seen += h->counts[i];
+        if (seen >= rank) {
+            unsigned long long v = hist_upper(i);
+            return (v < h->max_ns ? v : h->max_ns) / 1e3;
+        }
+    }
+    return h->max_ns / 1e3;
+}
+
+/* ========================= Hardware Counters ========================= */
+const char *const perf_event_names[PERF_EV_COUNT] = {
+    "cycles", "instructions", "l1d_misses", "llc_misses",
+    "cache_refs", "cache_misses", "ctx_switches",
+};
+
+/* Event encodings, indexed like perf_event_names */
+static const struct { uint32_t type; uint64_t config; } perf_events[PERF_EV_COUNT] = {
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+                          (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+    { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL |
+                          (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+    { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES },
+};
+
+/* perf_event_open_thread - Opens one disabled counter for this thread */
+static int perf_event_open_thread(int ev, int exclude_kernel) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size           = sizeof(attr);
+    attr.type           = perf_events[ev].type;
+    attr.config         = perf_events[ev].config;
+    attr.disabled       = 1;
+    attr.exclude_hv     = 1;
+    attr.exclude_kernel = exclude_kernel;
+    attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+}
+
+/*
+ * perf_counters_open - Opens the calling thread's counters, disabled.
+ * If kernel-mode counting is refused (EACCES/EPERM), all counters fall
+ * back to user mode so the set stays comparable.
+ * Returns: number of counters opened (0 if perf events are unavailable).
+ */
+int perf_counters_open(perf_counters_t *pc) {
+    int opened = 0;
+    memset(pc, 0, sizeof(*pc));
+    for (int ev = 0; ev < PERF_EV_COUNT; ev++) {
+        pc->fd[ev] = perf_event_open_thread(ev, pc->user_only);
+        if (pc->fd[ev] < 0 && !pc->user_only && (errno == EACCES || errno == EPERM)) {
+            /* Restart in user mode so every counter has the same scope */
+            for (int i = 0; i < ev; i++)
+                if (pc->fd[i] >= 0) close(pc->fd[i]);
+            pc->user_only = 1;
+            opened        = 0;
+            ev            = -1;
+            continue;
+        }
+        if (pc->fd[ev] >= 0) opened++;
+    }
+    return opened;
+}
+
+/* perf_counters_start - Zeroes and enables every open counter */
+void perf_counters_start(perf_counters_t *pc) {
+    for (int ev = 0; ev < PERF_EV_COUNT; ev++) {
+        if (pc->fd[ev] < 0) continue;
+        ioctl(pc->fd[ev], PERF_EVENT_IOC_RESET, 0);
+        ioctl(pc->fd[ev], PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+/*
+ * perf_counters_stop - Disables the counters and reads them into
+ * value[], scaling each by enabled/running time when the PMU had to
+ * multiplex more events than it has counters.
+ */
+void perf_counters_stop(perf_counters_t *pc) {
+    for (int ev = 0; ev < PERF_EV_COUNT; ev++) {
+        if (pc->fd[ev] < 0) continue;
+        ioctl(pc->fd[ev], PERF_EVENT_IOC_DISABLE, 0);
+    }
+    for (int ev = 0; ev < PERF_EV_COUNT; ev++) {
+        uint64_t v[3];   /* value, time_enabled, time_running */
+        pc->value[ev] = 0;
+        if (pc->fd[ev] < 0 || read(pc->fd[ev], v, sizeof(v)) != sizeof(v)) continue;
+        if (v[2] > 0 && v[2] < v[1])
+            pc->value[ev] = (uint64_t)((double)v[0] * v[1] / v[2]);
+        else
+            pc->value[ev] = v[0];
+    }
+}
+
+/* perf_counters_close - Closes every open counter */
+void perf_counters_close(perf_counters_t *pc) {
+    for (int ev = 0; ev < PERF_EV_COUNT; ev++) {
+        if (pc->fd[ev] >= 0) close(pc->fd[ev]);
+        pc->fd[ev] = -1;
+    }
+}
+
+/* ========================= NUMA Placement ============================ */
+#define NUMA_MAX_NODES  64      /* one unsigned long nodemask */
+
+numa_policy_t g_numa;           /* NUMA_DEFAULT: plain malloc() */
+
+/* numa_node_exists - True if /sys lists the node */
+static int numa_node_exists(int node) {
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d", node);
+    return access(path, F_OK) == 0;
+}
+
+/*
+ * numa_current_node - NUMA node of the CPU the caller is running on.
+ * Returns: node id, or 0 if getcpu() is unavailable.
+ */
+int numa_current_node(void) {
+    unsigned cpu, node;
+    if (syscall(SYS_getcpu, &cpu, &node, NULL) < 0) return 0;
+    return (int)node;
+}
+
+/* numa_target_node - Node the current policy binds to, -1 for default */
+static int numa_target_node(void) {
+    switch (g_numa.mode) {
+    case NUMA_LOCAL:
+        return numa_current_node();
+    case NUMA_REMOTE: {
+        int local = numa_current_node();
+        for (int i = 1; i < NUMA_MAX_NODES; i++) {
+            int node = (local + i) % NUMA_MAX_NODES;
+            if (numa_node_exists(node)) return node;
+        }
+        return local;
+    }
+    case NUMA_NODE:
+        return g_numa.node;
+    default:
+        return -1;
+    }
+}
+
+/*
+ * numa_policy_parse - Parses a -N argument: "local", "remote" or a node id.
+ * Returns: 0 on success, -1 on an unknown spec or missing node.
+ */
+int numa_policy_parse(numa_policy_t *p, const char *spec) {
+    char *end;
+    memset(p, 0, sizeof(*p));
+    if (strcmp(spec, "local") == 0)  { p->mode = NUMA_LOCAL;  return 0; }
+    if (strcmp(spec, "remote") == 0) { p->mode = NUMA_REMOTE; return 0; }
+
+    long node = strtol(spec, &end, 10);
+    if (end == spec || *end || node < 0 || node >= NUMA_MAX_NODES ||
+        !numa_node_exists((int)node))
+        return -1;
+    p->mode = NUMA_NODE;
+    p->node = (int)node;
+    return 0;
+}
+
+/* numa_policy_describe - Prints the buffer placement once at startup */
+void numa_policy_describe(const numa_policy_t *p, const char *who) {
+    switch (p->mode) {
+    case NUMA_LOCAL:  printf("[%s] NUMA: buffers bound to the local node\n", who);  break;
+    case NUMA_REMOTE: printf("[%s] NUMA: buffers bound to a remote node\n", who);  break;
+    case NUMA_NODE:   printf("[%s] NUMA: buffers bound to node %d\n", who, p->node); break;
+    default:          break;
+    }
+}
+
+/*
+ * numa_bind - Binds [ptr, ptr+len) to the node chosen by g_numa. Must run
+ * before the pages are first touched; a failure leaves them unplaced.
+ */
+static void numa_bind(void *ptr, size_t len) {
+    int node = numa_target_node();
+    if (node < 0) return;
+    unsigned long mask = 1UL << node;
+    if (syscall(SYS_mbind, ptr, len, MPOL_BIND, &mask,
+                sizeof(mask) * 8 + 1, 0UL) < 0)
+        perror("mbind");
+}
+
+/*
+ * numa_alloc - Allocates len bytes placed per g_numa. Under a binding
+ * policy the pages are mmap()ed, mbind()ed with MPOL_BIND and faulted
+ * in here; if mbind() fails the buffer is still usable, just unplaced.
+ * Returns: buffer (free with numa_free), or NULL on failure.
+ */
+void *numa_alloc(size_t len) {
+    if (g_numa.mode == NUMA_DEFAULT) return malloc(len);
+
+    void *ptr = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr == MAP_FAILED) return NULL;
+    numa_bind(ptr, len);
+    memset(ptr, 0, len);
+    return ptr;
+}
+
+/* numa_free - Releases a numa_alloc() buffer of the same length */
+void numa_free(void *ptr, size_t len) {
+    if (!ptr) return;
+    if (g_numa.mode == NUMA_DEFAULT) free(ptr);
+    else                             munmap(ptr, len);
+}
+
+/* ========================= Message Management ======================== */
+
+int g_hugepages = 0;
+
+/*
+ * arena_map - Maps a 2 MiB-aligned region of len bytes (a multiple of
+ * HUGEPAGE_SIZE) for message fields. Explicit MAP_HUGETLB pages are
+ * tried first; if the hugetlb pool is empty the region is over-mapped,
+ * trimmed to 2 MiB alignment and madvise(MADV_HUGEPAGE)d so THP can
+ * back it. The first call reports which kind of page was obtained.
+ * Returns: region, or NULL on failure.
+ */
+static char *arena_map(size_t len) {
+    static int reported = 0;
+    const char *kind = "MAP_HUGETLB";
+
+    char *p = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (p == MAP_FAILED) {
+        char *raw = mmap(NULL, len + HUGEPAGE_SIZE, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) return NULL;
+        p = (char *)(((uintptr_t)raw + HUGEPAGE_SIZE - 1) & ~(HUGEPAGE_SIZE - 1));
+        if (p > raw) munmap(raw, p - raw);
+        munmap(p + len, (raw + HUGEPAGE_SIZE) - p);
+        if (madvise(p, len, MADV_HUGEPAGE) < 0) kind = "4 KiB pages (no THP)";
+        else                                    kind = "THP (MADV_HUGEPAGE)";
+    }
+    if (!__atomic_exchange_n(&reported, 1, __ATOMIC_RELAXED))
+        printf("[Arena] Message fields backed by %s\n", kind);
+    return p;
+}
+
+/*
+ * alloc_message - Allocates a message_t with 8 heap-allocated string fields.
+ * @msg_size: Total message size; each field gets msg_size / NUM_FIELDS bytes.
+ * Each field is filled with a repeating pattern to ensure pages are faulted in.
+ * Fields are placed per g_numa (numa_alloc), so call this from the thread
+ * that will send them. With g_hugepages the fields are instead carved back
+ * to back from one 2 MiB-aligned arena, so a message of up to 2 MiB spans a
+ * single huge page: one TLB entry and one page to pin per zero-copy send.
+ */
+message_t *alloc_message(int msg_size) {
+    message_t *msg = (message_t *)calloc(1, sizeof(message_t));
+    if (!msg) { perror("malloc message_t"); exit(EXIT_FAILURE); }
+
+    /* Round up so msg_size bytes always fit; the remainder is spread */
+    msg->field_size = (msg_size + NUM_FIELDS - 1) / NUM_FIELDS;
+    if (msg_size <= 0) {
+        fprintf(stderr, "Error: msg_size must be >= 1 byte\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (g_hugepages) {
+        size_t used = (size_t)msg->field_size * NUM_FIELDS;
+        msg->arena_len = (used + HUGEPAGE_SIZE - 1) & ~(HUGEPAGE_SIZE - 1);
+        msg->arena     = arena_map(msg->arena_len);
+        if (!msg->arena) { perror("mmap message arena"); exit(EXIT_FAILURE); }
+        numa_bind(msg->arena, msg->arena_len);
+        for (int i = 0; i < NUM_FIELDS; i++) {
+            msg->fields[i] = msg->arena + (size_t)i * msg->field_size;
+            memset(msg->fields[i], 'A' + i, msg->field_size);
+        }
+        message_set_size(msg, msg_size);
+        return msg;
+    }
+
+    for (int i = 0; i < NUM_FIELDS; i++) {
+        msg->fields[i] = (char *)numa_alloc(msg->field_size);
+        if (!msg->fields[i]) { perror("alloc field"); exit(EXIT_FAILURE); }
+        memset(msg->fields[i], 'A' + i, msg->field_size);
+    }
+    message_set_size(msg, msg_size);
+    return msg;
+}
+
+/* free_message - Frees all 8 fields (or their arena) and the message structure */
+void free_message(message_t *msg) {
+    if (!msg) return;
+    if (msg->arena)
+        munmap(msg->arena, msg->arena_len);
+    else
+        for (int i = 0; i < NUM_FIELDS; i++) numa_free(msg->fields[i], msg->field_size);
+    free(msg);
+}
+
+/*
+ * message_set_size - Sets how many payload bytes the message carries.
+ * len (capped at the fields' capacity) is split as evenly as possible:
+ * the first len % NUM_FIELDS fields carry one extra byte, so no
+ * remainder is dropped. Also updates the frame header.
+ */
+void message_set_size(message_t *msg, int len) {
+    int cap = msg->field_size * NUM_FIELDS;
+    if (len > cap) len = cap;
+    if (len < 0)   len = 0;
+
+    int base = len / NUM_FIELDS, extra = len % NUM_FIELDS;
+    for (int i = 0; i < NUM_FIELDS; i++)
+        msg->field_len[i] = base + (i < extra);
+    msg->len     = len;
+    msg->hdr.len = (uint32_t)len;
+}
+
+/*
+ * message_iov - Describes the message's wire bytes: the frame header
+ * (if framed) followed by each non-empty field.
+ * Returns: number of iovecs written (at most MSG_IOVS).
+ */
+int message_iov(message_t *msg, struct iovec *iov) {
+    int n = 0;
+    if (msg->framed) {
+        iov[n].iov_base = &msg->hdr;
+        iov[n].iov_len  = sizeof(msg->hdr);
+        n++;
+    }
+    for (int i = 0; i < NUM_FIELDS; i++) {
+        if (msg->field_len[i] == 0) continue;
+        iov[n].iov_base = msg->fields[i];
+        iov[n].iov_len  = msg->field_len[i];
+        n++;
+    }
+    return n;
+}
+
+/* ========================= Payload Generators ======================== */
+static const char *const payload_names[] = { "static", "counter", "random", "record" };
+
+/* payload_parse - Maps a -G name to its mode. Returns: 0, or -1 if unknown */
+int payload_parse(payload_mode_t *mode, const char *spec) {
+    for (int i = 0; i < (int)(sizeof(payload_names) / sizeof(payload_names[0])); i++) {
+        if (strcmp(spec, payload_names[i]) == 0) {
+            *mode = (payload_mode_t)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char *payload_name(payload_mode_t mode) {
+    return payload_names[mode];
+}
+
+/* payload_init - Seeds a per-thread generator */
+void payload_init(payload_gen_t *g, payload_mode_t mode, uint64_t seed) {
+    g->mode = mode;
+    g->seq  = 0;
+    g->rng  = seed * 0x9E3779B97F4A7C15ULL + 1;
+}
+
+/* splitmix64 - One PRNG step: 8 well-mixed bytes for a few cycles */
+static inline uint64_t splitmix64(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/* put_dec - Writes v as exactly 'width' zero-padded decimal digits */
+static inline void put_dec(char *p, int width, uint64_t v) {
+    for (int i = width - 1; i >= 0; i--) {
+        p[i] = (char)('0' + v % 10);
+        v /= 10;
+    }
+}
+
+/* One 64-byte record; numeric columns are rewritten at fixed offsets */
+#define RECORD_LEN  64
+static const char record_template[RECORD_LEN + 1] =
+    "{\"id\":0000000000,\"ts\":0000000000000,\"px\":00000000,\"qty\":000000}\n";
+
+/*
+ * payload_fill - Rewrites msg's fields for the next message. The record
+ * generator formats each record in a stack buffer and copies it out, the
+ * way a serializer produces a row; a field's trailing partial record is
+ * truncated.
+ */
+void payload_fill(payload_gen_t *g, message_t *msg) {
+    uint64_t seq = g->seq++;
+
+    switch (g->mode) {
+    case PAYLOAD_COUNTER:
+        for (int i = 0; i < NUM_FIELDS; i++) {
+            size_t   fs    = (size_t)msg->field_len[i];
+            uint64_t stamp = (seq << 3) | (uint64_t)i;
+            memcpy(msg->fields[i], &stamp, fs < sizeof(stamp) ? fs : sizeof(stamp));
+        }
+        break;
+
+    case PAYLOAD_RANDOM:
+        for (int i = 0; i < NUM_FIELDS; i++) {
+            char  *p  = msg->fields[i];
+            size_t fs = (size_t)msg->field_len[i];
+            size_t n  = 0;
+            for (; n + 8 <= fs; n += 8) {
+                uint64_t r = splitmix64(&g->rng);
+                memcpy(p + n, &r, 8);
+            }
+            if (n < fs) {
+                uint64_t r = splitmix64(&g->rng);
+                memcpy(p + n, &r, fs - n);
+            }
+        }
+        break;
+
+    case PAYLOAD_RECORD: {
+        char     rec[RECORD_LEN];
+        uint64_t ts = timer_now_ns() / 1000;
+        uint64_t id = seq * NUM_FIELDS *
+                      (((size_t)msg->field_size + RECORD_LEN - 1) / RECORD_LEN);
+        memcpy(rec, record_template, RECORD_LEN);
+        for (int i = 0; i < NUM_FIELDS; i++) {
+            size_t fs = (size_t)msg->field_len[i];
+            for (size_t off = 0; off < fs; off += RECORD_LEN) {
+                uint64_t r = splitmix64(&g->rng);
+                put_dec(rec + 6,  10, id++);
+                put_dec(rec + 22, 13, ts);
+                put_dec(rec + 41, 8,  r % 100000000ULL);
+                put_dec(rec + 56, 6,  (r >> 32) % 1000000ULL);
+                memcpy(msg->fields[i] + off, rec,
+                       fs - off < RECORD_LEN ? fs - off : RECORD_LEN);
+            }
+        }
+        break;
+    }
+
+    default:
+        break;
+    }
+}
+
+/* ========================= Checksums ================================= */
+#define CRC32C_POLY  0x82F63B78u    /* Castagnoli polynomial, bit-reflected */
+
+static uint32_t       crc32c_table[256];
+static int            crc32c_hw;
+static pthread_once_t crc32c_once = PTHREAD_ONCE_INIT;
+
+/* crc32c_init - Builds the byte table and probes SSE4.2 (CPUID 1 ECX) */
+static void crc32c_init(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++)
+            c = (c >> 1) ^ (CRC32C_POLY & (0u - (c & 1u)));
+        crc32c_table[i] = c;
+    }
+#if defined(__x86_64__)
+    unsigned int eax, ebx, ecx, edx;
+    crc32c_hw = __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_SSE4_2);
+#endif
+}
+
+#if defined(__x86_64__)
+/* crc32c_sse42 - 8 bytes per crc32 instruction, then the byte tail */
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_sse42(uint32_t crc, const unsigned char *p, size_t len) {
+    uint64_t c = crc;
+    for (; len >= 8; p += 8, len -= 8) {
+        uint64_t v;
+        memcpy(&v, p, 8);
+        c = _mm_crc32_u64(c, v);
+    }
+    crc = (uint32_t)c;
+    for (; len > 0; p++, len--) crc = _mm_crc32_u8(crc, *p);
+    return crc;
+}
+#endif
+
+/* crc32c_table_update - Portable one-byte-per-step fallback */
+static uint32_t crc32c_table_update(uint32_t crc, const unsigned char *p, size_t len) {
+    for (; len > 0; p++, len--)
+        crc = crc32c_table[(crc ^ *p) & 0xff] ^ (crc >> 8);
+    return crc;
+}
+
+/*
+ * crc32c_update - Extends a CRC32C over len more bytes of data.
+ * Returns: the CRC of everything fed so far (0 for no bytes).
+ */
+uint32_t crc32c_update(uint32_t crc, const void *data, size_t len) {
+    pthread_once(&crc32c_once, crc32c_init);
+#if defined(__x86_64__)
+    if (crc32c_hw) return ~crc32c_sse42(~crc, (const unsigned char *)data, len);
+#endif
+    return ~crc32c_table_update(~crc, (const unsigned char *)data, len);
+}
+
+/* crc32c_impl - Names the CRC32C implementation in use */
+const char *crc32c_impl(void) {
+    pthread_once(&crc32c_once, crc32c_init);
+    return crc32c_hw ? "SSE4.2 crc32" : "byte table";
+}
+
+/* message_checksum - CRC32C of the message's payload, field by field */
+uint32_t message_checksum(const message_t *msg) {
+    uint32_t crc = 0;
+    for (int i = 0; i < NUM_FIELDS; i++)
+        crc = crc32c_update(crc, msg->fields[i], (size_t)msg->field_len[i]);
+    return crc;
+}
+
+/* ========================= Size Distributions ======================== */
+
+/* parse_range - Parses "MIN-MAX" with 1 <= MIN <= MAX. Returns: 0 or -1 */
+static int parse_range(const char *s, int *lo, int *hi, char **end) {
+    long a = strtol(s, end, 10);
+    if (*end == s || **end != '-') return -1;
+    s = *end + 1;
+    long b = strtol(s, end, 10);
+    if (*end == s || a < 1 || b < a || b > INT_MAX) return -1;
+    *lo = (int)a;
+    *hi = (int)b;
+    return 0;
+}
+
+/* load_trace - Reads one size per line; blank and '#' lines are skipped */
+static int load_trace(size_dist_t *d, const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) { perror(path); return -1; }
+
+    long cap = 1024;
+    char line[64];
+    d->trace = malloc(cap * sizeof(int));
+    while (d->trace && fgets(line, sizeof(line), f)) {
+        char *end;
+        long  v = strtol(line, &end, 10);
+        if (end == line || v < 1) continue;
+        if (d->ntrace == cap) {
+            int *grown = realloc(d->trace, (cap *= 2) * sizeof(int));
+            if (!grown) { free(d->trace); d->trace = NULL; break; }
+            d->trace = grown;
+        }
+        d->trace[d->ntrace++] = v > INT_MAX ? INT_MAX : (int)v;
+    }
+    fclose(f);
+    if (!d->trace || d->ntrace == 0) {
+        fprintf(stderr, "%s: no message sizes\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * size_dist_parse - Parses a -D spec (see MT25062_Netbench.h).
+ * Returns: 0 on success, -1 on a malformed spec or unreadable trace.
+ */
+int size_dist_parse(size_dist_t *d, const char *spec) {
+    char *end;
+    memset(d, 0, sizeof(*d));
+
+    if (strcmp(spec, "fixed") == 0) return 0;
+
+    if (strncmp(spec, "uniform:", 8) == 0) {
+        d->mode = SIZE_UNIFORM;
+        return (parse_range(spec + 8, &d->lo, &d->hi, &end) == 0 && !*end) ? 0 : -1;
+    }
+
+    if (strncmp(spec, "bimodal:", 8) == 0) {
+        d->mode = SIZE_BIMODAL;
+        long small = strtol(spec + 8, &end, 10);
+        if (*end != ',') return -1;
+        long large = strtol(end + 1, &end, 10);
+        if (*end != ',') return -1;
+        long pct   = strtol(end + 1, &end, 10);
+        if (*end || small < 1 || large < 1 || pct < 0 || pct > 100) return -1;
+        d->lo     = (int)small;
+        d->hi     = (int)large;
+        d->pct_lo = (int)pct;
+        return 0;
+    }
+
+    if (strncmp(spec, "zipf:", 5) == 0) {
+        double alpha = 1.0;
+        d->mode = SIZE_ZIPF;
+        if (parse_range(spec + 5, &d->lo, &d->hi, &end) < 0) return -1;
+        if (*end == ',') alpha = strtod(end + 1, &end);
+        if (*end || alpha <= 0) return -1;
+
+        /* Ranks are power-of-two multiples of lo; the last one is hi */
+        double sum = 0;
+        for (long size = d->lo; d->nranks < SIZE_ZIPF_RANKS; size *= 2) {
+            sum += 1.0 / pow(d->nranks + 1, alpha);
+            d->cdf[d->nranks++] = sum;
+            if (size >= d->hi) break;
+        }
+        for (int k = 0; k < d->nranks; k++) d->cdf[k] /= sum;
+        return 0;
+    }
+
+    if (strncmp(spec, "trace:", 6) == 0) {
+        d->mode = SIZE_TRACE;
+        return load_trace(d, spec + 6);
+    }
+    return -1;
+}
+
+/* size_dist_describe - Prints the size distribution once at startup */
+void size_dist_describe(const size_dist_t *d, int max) {
+    switch (d->mode) {
+    case SIZE_UNIFORM:
+        printf("[Client] Sizes: uniform %d-%d bytes", d->lo, d->hi); break;
+    case SIZE_BIMODAL:
+        printf("[Client] Sizes: bimodal %d%% x %d bytes, %d%% x %d bytes",
+               d->pct_lo, d->lo, 100 - d->pct_lo, d->hi); break;
+    case SIZE_ZIPF:
+        printf("[Client] Sizes: zipf %d-%d bytes over %d ranks", d->lo, d->hi, d->nranks); break;
+    case SIZE_TRACE:
+        printf("[Client] Sizes: trace of %ld messages", d->ntrace); break;
+    default:
+        return;
+    }
+    printf(", capped at %d\n", max);
+}
+
+/* size_cap - Clamps a drawn size to [1, max], as size_gen_next() does */
+static int size_cap(long size, int max) {
+    if (size > max) size = max;
+    return size < 1 ? 1 : (int)size;
+}
+
+/*
+ * size_dist_mean - Expected message size of the distribution after the
+ * msg_size cap, matching what size_gen_next() draws on average.
+ * Returns: the mean size in bytes (max for fixed sizes).
+ */
+double size_dist_mean(const size_dist_t *d, int max) {
+    double sum = 0.0;
+    switch (d->mode) {
+    case SIZE_UNIFORM: {
+        /* Closed form: arithmetic series below max, then a capped tail */
+        double n   = (double)d->hi - d->lo + 1;
+        long   top = d->hi < max ? d->hi : max;
+        if (d->lo <= top) sum = ((double)d->lo + top) * ((double)top - d->lo + 1) / 2.0;
+        sum += (double)max * ((double)d->hi - (d->lo > top ? d->lo - 1 : top));
+        return sum / n;
+    }
+    case SIZE_BIMODAL:
+        return (d->pct_lo * size_cap(d->lo, max) +
+                (100 - d->pct_lo) * size_cap(d->hi, max)) / 100.0;
+    case SIZE_ZIPF:
+        for (int k = 0; k < d->nranks; k++) {
+            long   r = (long)d->lo << k;
+            double p = d->cdf[k] - (k > 0 ? d->cdf[k - 1] : 0.0);
+            sum += p * size_cap((k == d->nranks - 1 || r > d->hi) ? d->hi : r, max);
+        }
+        return sum;
+    case SIZE_TRACE:
+        for (long i = 0; i < d->ntrace; i++) sum += size_cap(d->trace[i], max);
+        return d->ntrace ? sum / d->ntrace : max;
+    default:
+        return max;
+    }
+}
+
+/* size_gen_init - Per-thread sampler; trace replay starts at a seed offset */
+void size_gen_init(size_gen_t *g, const size_dist_t *d, int max, uint64_t seed) {
+    g->dist = d;
+    g->max  = max;
+    g->rng  = seed * 0xD1B54A32D192ED03ULL + 7;
+    g->pos  = d->ntrace ? (long)((seed * 7919) % (uint64_t)d->ntrace) : 0;
+}
+
+/* size_gen_next - Draws the next message size, in [1, max] */
+int size_gen_next(size_gen_t *g) {
+    const size_dist_t *d = g->dist;
+    int size;
+
+    switch (d->mode) {
+    case SIZE_UNIFORM:
+        size = d->lo + (int)(splitmix64(&g->rng) % (uint64_t)(d->hi - d->lo + 1));
+        break;
+    case SIZE_BIMODAL:
+        size = (int)(splitmix64(&g->rng) % 100) < d->pct_lo ? d->lo : d->hi;
+        break;
+    case SIZE_ZIPF: {
+        double u = (splitmix64(&g->rng) >> 11) * (1.0 / 9007199254740992.0);
+        int    k = 0;
+        while (k < d->nranks - 1 && u > d->cdf[k]) k++;
+        long   r = (long)d->lo << k;
+        size = (k == d->nranks - 1 || r > d->hi) ? d->hi : (int)r;
+        break;
+    }
+    case SIZE_TRACE:
+        size = d->trace[g->pos];
+        if (++g->pos == d->ntrace) g->pos = 0;
+        break;
+    default:
+        size = g->max;
+        break;
+    }
+    if (size > g->max) size = g->max;
+    return size < 1 ? 1 : size;
+}
+
+/* ========================= Open-Loop Pacing ========================== */
+#define PACE_SPIN_NS  50000     /* spin the last 50 us; sleeps wake late */
+
+/*
+ * pace_parse - Parses "RATE[g][:const|:poisson]": RATE messages/sec, or
+ * Gbit/s with the g suffix, e.g. "200000", "2.5g:poisson".
+ * Returns: 0 on success, -1 on a malformed spec.
+ */
+int pace_parse(pace_spec_t *p, const char *spec) {
+    char  *end;
+    double rate = strtod(spec, &end);
+    if (end == spec || !(rate > 0)) return -1;
+
+    memset(p, 0, sizeof(*p));
+    if (*end == 'g' || *end == 'G') {
+        p->bits_per_sec = rate * 1e9;
+        end++;
+    } else {
+        p->msgs_per_sec = rate;
+    }
+    if (*end == '\0' || strcmp(end, ":const") == 0) return 0;
+    if (strcmp(end, ":poisson") == 0) {
+        p->arrival = ARRIVAL_POISSON;
+        return 0;
+    }
+    return -1;
+}
+
+/* pace_describe - Prints the offered load, total and per thread */
+void pace_describe(const pace_spec_t *p, int threads) {
+    const char *arrivals = p->arrival == ARRIVAL_POISSON ? "Poisson" : "constant";
+    if (p->bits_per_sec > 0)
+        printf("[Client] Open loop: %.3f Gbit/s offered (%.3f per thread), %s arrivals\n",
+               p->bits_per_sec / 1e9, p->bits_per_sec / 1e9 / threads, arrivals);
+    else
+        printf("[Client] Open loop: %.0f msgs/sec offered (%.0f per thread), %s arrivals\n",
+               p->msgs_per_sec, p->msgs_per_sec / threads, arrivals);
+}
+
+/* pacer_init - Per-thread schedule starting at start_ns */
+void pacer_init(pacer_t *pc, const pace_spec_t *p, int threads,
+                uint64_t start_ns, uint64_t seed) {
+    pc->spec    = p;
+    pc->share   = 1.0 / threads;
+    pc->next_ns = (double)start_ns;
+    pc->rng     = seed * 0x9E3779B97F4A7C15ULL + 3;
+}
+
+/*
+ * pacer_next - Takes the next slot for a send of 'msgs' messages and
+ * wire_bytes bytes, and advances the schedule by its mean gap (scaled by
+ * an Exp(1) draw for Poisson arrivals).
+ * Returns: the send's intended start time.
+ */
+uint64_t pacer_next(pacer_t *pc, size_t wire_bytes, int msgs) {
+    const pace_spec_t *p   = pc->spec;
+    uint64_t           due = (uint64_t)pc->next_ns;
+    double             gap = p->bits_per_sec > 0
+                           ? wire_bytes * 8e9 / (p->bits_per_sec * pc->share)
+                           : msgs * 1e9 / (p->msgs_per_sec * pc->share);
+    if (p->arrival == ARRIVAL_POISSON) {
+        /* u in (0, 1], so the log is finite */
+        double u = ((splitmix64(&pc->rng) >> 11) + 1) * (1.0 / 9007199254740992.0);
+        gap *= -log(u);
+    }
+    pc->next_ns += gap;
+    return due;
+}
+
+/*
+ * pace_wait - Returns at target_ns (timer_now_ns() base): sleeps through
+ * most of a long gap, then spins so the wakeup lands within the clock's
+ * resolution rather than the scheduler's. A target already in the past
+ * returns at once.
+ */
+void pace_wait(uint64_t target_ns) {
+    uint64_t now = timer_now_ns();
+    if (target_ns <= now) return;
+    if (target_ns - now > PACE_SPIN_NS) {
+        uint64_t        nap_ns = target_ns - now - PACE_SPIN_NS;
+        struct timespec nap    = { (time_t)(nap_ns / 1000000000ULL),
+                                   (long)(nap_ns % 1000000000ULL) };
+        nanosleep(&nap, NULL);
+    }
+    while (timer_now_ns() < target_ns) {
+#if defined(__x86_64__)
+        _mm_pause();
+#endif
+    }
+}
+
+/*
+ * pace_kernel_rate - Converts a rate spec to one socket's share in
+ * bytes/sec; a messages/sec rate is scaled by the mean wire size of a
+ * message (payload plus any frame header).
+ * Returns: the per-socket pacing rate in bytes/sec.
+ */
+double pace_kernel_rate(const pace_spec_t *p, double wire_bytes, int threads) {
+    double total = p->bits_per_sec > 0 ? p->bits_per_sec / 8.0
+                                       : p->msgs_per_sec * wire_bytes;
+    return total / threads;
+}
+
+/* ========================= Network Utilities ========================= */
+
+/*
+ * send_all - Sends exactly len bytes, handling partial sends.
+ * Returns: Total bytes sent, or -1 on error.
+ */
+ssize_t send_all(int sock, const void *buf, size_t len, int flags) {
+    const char *p = (const char *)buf;
+    size_t remaining = len;
+    while (remaining > 0) {
+        ssize_t sent = send(sock, p, remaining, flags);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p         += sent;
+        remaining -= sent;
+    }
+    return (ssize_t)len;
+}
+
+/*
+ * sendmsg_all - sendmsg() until the whole iovec is written. After a
+ * short write the iovec is advanced past the sent bytes, so a batch of
+ * framed messages never leaves the stream mid-frame. mhdr->msg_iov and
+ * its entries are modified.
+ * Returns: Total bytes sent, or -1 on error.
+ */
+ssize_t sendmsg_all(int sock, struct msghdr *mhdr, int flags) {
+    ssize_t total = 0;
+    while (mhdr->msg_iovlen > 0) {
+        ssize_t sent = sendmsg(sock, mhdr, flags);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        total += sent;
+        while (mhdr->msg_iovlen > 0 && (size_t)sent >= mhdr->msg_iov->iov_len) {
+            sent -= (ssize_t)mhdr->msg_iov->iov_len;
+            mhdr->msg_iov++;
+            mhdr->msg_iovlen--;
+        }
+        if (mhdr->msg_iovlen > 0) {
+            mhdr->msg_iov->iov_base  = (char *)mhdr->msg_iov->iov_base + sent;
+            mhdr->msg_iov->iov_len  -= (size_t)sent;
+        }
+    }
+    return total;
+}
+
+/*
+ * socket_set_pacing - Caps the socket's pacing rate (SO_MAX_PACING_RATE,
+ * bytes/sec). Kernels before 4.20 keep a 32-bit rate and accept the
+ * 64-bit option by reading only its low half, so a rate above ~34
+ * Gbit/s would be silently truncated. The rate is read back: a 4-byte
+ * answer means a 32-bit kernel, and the rate is clamped just below
+ * ~0U (which means "unlimited" there) with a warning.
+ * Returns: 0 on success, -1 on error (errno set).
+ */
+int socket_set_pacing(int sock, double bytes_per_sec) {
+    uint64_t rate = bytes_per_sec < 1.0 ? 1 : (uint64_t)bytes_per_sec;
+    if (setsockopt(sock, SOL_SOCKET, SO_MAX_PACING_RATE, &rate, sizeof(rate)) < 0)
+        return -1;
+
+    uint64_t  got = 0;
+    socklen_t len = sizeof(got);
+    if (getsockopt(sock, SOL_SOCKET, SO_MAX_PACING_RATE, &got, &len) < 0) return -1;
+    if (len == sizeof(got) || rate < UINT32_MAX) return 0;
+
+    uint32_t rate32 = UINT32_MAX - 1;
+    fprintf(stderr, "SO_MAX_PACING_RATE is 32-bit: %.2f Gbit/s clamped to %.2f Gbit/s\n",
+            rate * 8 / 1e9, rate32 * 8.0 / 1e9);
+    return setsockopt(sock, SOL_SOCKET, SO_MAX_PACING_RATE, &rate32, sizeof(rate32));
+}
+
+/*
+ * recv_all - Receives exactly len bytes (an echoed message).
+ * Returns: len, or -1 with errno set (ECONNRESET if the peer closed).
+ */
+ssize_t recv_all(int sock, void *buf, size_t len) {
+    char  *p = (char *)buf;
+    size_t remaining = len;
+    while (remaining > 0) {
+        ssize_t got = recv(sock, p, remaining, 0);
+        if (got == 0) { errno = ECONNRESET; return -1; }
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p         += got;
+        remaining -= got;
+    }
+    return (ssize_t)len;
+}
+
+/*
+ * connect_to_server - Creates a TCP socket and connects to server.
+ * Returns: Connected socket fd, or -1 on error.
+ */
+int connect_to_server(const char *server_ip, int server_port) {
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock < 0) { perror("socket"); return -1; }
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port   = htons(server_port);
+    if (inet_pton(AF_INET, server_ip, &addr.sin_addr) <= 0) {
+        perror("inet_pton"); close(sock); return -1;
+    }
+    if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        perror("connect"); close(sock); return -1;
+    }
+    return sock;
+}
+
+/*
+ * create_server_socket - Creates, binds, and listens on a TCP socket.
+ * @port:      Port number to bind to.
+ * @reuseport: Set SO_REUSEPORT so several listeners can share the port;
+ *             the kernel then spreads incoming connections across them.
+ * Returns: Server socket file descriptor.
+ */
+int create_server_socket(int port, int reuseport) {
+    int server_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (server_fd < 0) {
+        perror("socket");
+        exit(EXIT_FAILURE);
+    }
+
+    int opt = 1;
+    if (setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
+        perror("setsockopt SO_REUSEADDR");
+        exit(EXIT_FAILURE);
+    }
+    if (reuseport &&
+        setsockopt(server_fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
+        perror("setsockopt SO_REUSEPORT");
+        exit(EXIT_FAILURE);
+    }
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port        = htons(port);
+
+    if (bind(server_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        perror("bind");
+        exit(EXIT_FAILURE);
+    }
+
+    if (listen(server_fd, BACKLOG) < 0) {
+        perror("listen");
+        exit(EXIT_FAILURE);
+    }
+
+    printf("[Server] Listening on port %d%s\n", port,
+           reuseport ? " (SO_REUSEPORT)" : "");
+    return server_fd;
+}
+
+/* ========================= Output Utilities ========================== */
+
+/*
+ * print_results - Prints benchmark results in parseable CSV format.
+ * Columns after elapsed: p50, p90, p99, p99.9 and max latency (us).
+ * With counters (-p), the perf_event_names columns follow in order,
+ * then cycles per byte.
+ */
+void print_results(const char *impl, int msg_size, int threads,
+                   long long total_bytes, double elapsed,
+                   double avg_lat, const latency_hist_t *hist,
+                   const perf_counters_t *counters) {
+    double throughput_gbps = (total_bytes * 8.0) / (elapsed * 1e9);
+    printf("RESULT,%s,%d,%d,%.4f,%.2f,%lld,%.4f,%.2f,%.2f,%.2f,%.2f,%.2f",
+           impl, msg_size, threads, throughput_gbps, avg_lat,
+           total_bytes, elapsed,
+           hist_percentile_us(hist, 50.0), hist_percentile_us(hist, 90.0),
+           hist_percentile_us(hist, 99.0), hist_percentile_us(hist, 99.9),
+           hist->max_ns / 1e3);
+    if (counters) {
+        for (int ev = 0; ev < PERF_EV_COUNT; ev++)
+            printf(",%llu", (unsigned long long)counters->value[ev]);
+        printf(",%.4f", total_bytes > 0 ?
+               (double)counters->value[PERF_EV_CYCLES] / total_bytes : 0.0);
+    }
+    printf("\n");
+}
+
+/* ========================= CPU Pinning =============================== */
+
+/* Topology of one allowed CPU, used to order compact/scatter policies */
+typedef struct {
+    int cpu;
+    int package;    /* physical_package_id                   */
+    int core;       /* core_id within the package             */
+    int sibling;    /* rank among SMT siblings of the core    */
+} cpu_topo_t;
+
+/* read_topology_id - Reads one integer from cpuN/topology, 0 if missing */
+static int read_topology_id(int cpu, const char *name) {
+    char path[128];
+    int  value = 0;
+    snprintf(path, sizeof(path),
+             "/sys/devices/system/cpu/cpu%d/topology/%s", cpu, name);
+    FILE *f = fopen(path, "r");
+    if (!f) return 0;
+    if (fscanf(f, "%d", &value) != 1) value = 0;
+    fclose(f);
+    return value;
+}
+
+static int cmp_compact(const void *a, const void *b) {
+    const cpu_topo_t *x = a, *y = b;
+    if (x->package != y->package) return x->package - y->package;
+    if (x->core    != y->core)    return x->core    - y->core;
+    return x->cpu - y->cpu;
+}
+
+static int cmp_scatter(const void *a, const void *b) {
+    const cpu_topo_t *x = a, *y = b;
+    if (x->sibling != y->sibling) return x->sibling - y->sibling;
+    if (x->core    != y->core)    return x->core    - y->core;
+    if (x->package != y->package) return x->package - y->package;
+    return x->cpu - y->cpu;
+}
+
+/*
+ * cpu_policy_parse - Builds a placement policy from a -P argument:
+ * "compact", "scatter" or a CPU list such as "0,2,4-7".
+ * Returns: 0 on success, -1 on a malformed spec or empty CPU set.
+ */
+int cpu_policy_parse(cpu_policy_t *p, const char *spec) {
+    memset(p, 0, sizeof(*p));
+
+    if (strcmp(spec, "compact") == 0 || strcmp(spec, "scatter") == 0) {
+        cpu_set_t allowed;
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) < 0) {
+            perror("sched_getaffinity");
+            return -1;
+        }
+        static cpu_topo_t topo[PIN_MAX_CPUS];
+        int n = 0;
+        for (int cpu = 0; cpu < CPU_SETSIZE && n < PIN_MAX_CPUS; cpu++) {
+            if (!CPU_ISSET(cpu, &allowed)) continue;
+            topo[n].cpu     = cpu;
+            topo[n].package = read_topology_id(cpu, "physical_package_id");
+            topo[n].core    = read_topology_id(cpu, "core_id");
+            topo[n].sibling = 0;
+            for (int j = 0; j < n; j++)
+                if (topo[j].package == topo[n].package && topo[j].core == topo[n].core)
+                    topo[n].sibling++;
+            n++;
+        }
+        p->mode = (spec[0] == 'c') ? PIN_COMPACT : PIN_SCATTER;
+        qsort(topo, n, sizeof(topo[0]),
+              p->mode == PIN_COMPACT ? cmp_compact : cmp_scatter);
+        for (int i = 0; i < n; i++) p->cpus[i] = topo[i].cpu;
+        p->ncpus = n;
+        return n > 0 ? 0 : -1;
+    }
+
+    /* Explicit list: comma-separated CPUs or lo-hi ranges */
+    const char *s = spec;
+    p->mode = PIN_LIST;
+    while (*s) {
+        char *end;
+        long  lo = strtol(s, &end, 10), hi = lo;
+        if (end == s || lo < 0) return -1;
+        if (*end == '-') {
+            s  = end + 1;
+            hi = strtol(s, &end, 10);
+            if (end == s || hi < lo) return -1;
+        }
+        for (long cpu = lo; cpu <= hi && p->ncpus < PIN_MAX_CPUS; cpu++)
+            p->cpus[p->ncpus++] = (int)cpu;
+        if (*end == ',') end++;
+        else if (*end)   return -1;
+        s = end;
+    }
+    return p->ncpus > 0 ? 0 : -1;
+}
+
+/* cpu_policy_cpu - CPU for thread 'index', or -1 when not pinning */
+int cpu_policy_cpu(const cpu_policy_t *p, int index) {
+    if (p->mode == PIN_NONE || p->ncpus == 0) return -1;
+    return p->cpus[index % p->ncpus];
+}
+
+/* cpu_policy_describe - Prints the policy's CPU order once at startup */
+void cpu_policy_describe(const cpu_policy_t *p, const char *who) {
+    static const char *const names[] = { "none", "compact", "scatter", "list" };
+    if (p->mode == PIN_NONE) return;
+    printf("[%s] Pinning %s:", who, names[p->mode]);
+    for (int i = 0; i < p->ncpus && i < 16; i++) printf(" %d", p->cpus[i]);
+    printf("%s\n", p->ncpus > 16 ? " ..." : "");
+}
+
+/*
+ * pin_thread_to_cpu - Binds the calling thread to one CPU (no-op for -1).
+ * Returns: 0 on success, -1 if the kernel refused the affinity.
+ */
+int pin_thread_to_cpu(int cpu) {
+    if (cpu < 0) return 0;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (err != 0) {
+        fprintf(stderr, "pthread_setaffinity_np(cpu %d): %s\n", cpu, strerror(err));
+        return -1;
+    }
+    return 0;
+}
+
+/* ========================= io_uring Ring ============================= */
+
+/*
+ * uring_init - Creates a ring and maps the SQ/CQ rings and SQE array.
+ * Requires IORING_FEAT_SINGLE_MMAP (>= 5.4); other feature bits are
+ * left in r->features for callers to check.
+ * Returns: 0 on success, -1 with errno set on failure.
+ */
+int uring_init(uring_t *r, unsigned entries) {
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    memset(r, 0, sizeof(*r));
+
+    r->ring_fd = (int)syscall(__NR_io_uring_setup, entries, &p);
+    if (r->ring_fd < 0) return -1;
+    if (!(p.features & IORING_FEAT_SINGLE_MMAP)) {
+        close(r->ring_fd);
+        errno = ENOSYS;
+        return -1;
+    }
+
+    size_t sq_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    size_t cq_len = p.cq_off.cqes  + p.cq_entries * sizeof(struct io_uring_cqe);
+    r->ring_len   = sq_len > cq_len ? sq_len : cq_len;
+
+    char *ring = mmap(NULL, r->ring_len, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, r->ring_fd, IORING_OFF_SQ_RING);
+    if (ring == MAP_FAILED) { close(r->ring_fd); return -1; }
+    r->ring_ptr = ring;
+
+    r->sqes = mmap(NULL, p.sq_entries * sizeof(struct io_uring_sqe),
+                   PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   r->ring_fd, IORING_OFF_SQES);
+    if (r->sqes == MAP_FAILED) {
+        munmap(ring, r->ring_len);
+        close(r->ring_fd);
+        return -1;
+    }
+
+    r->sq_head    = (unsigned *)(ring + p.sq_off.head);
+    r->sq_tail    = (unsigned *)(ring + p.sq_off.tail);
+    r->sq_mask    = (unsigned *)(ring + p.sq_off.ring_mask);
+    r->sq_array   = (unsigned *)(ring + p.sq_off.array);
+    r->cq_head    = (unsigned *)(ring + p.cq_off.head);
+    r->cq_tail    = (unsigned *)(ring + p.cq_off.tail);
+    r->cq_mask    = (unsigned *)(ring + p.cq_off.ring_mask);
+    r->cqes       = (struct io_uring_cqe *)(ring + p.cq_off.cqes);
+    r->sq_entries = p.sq_entries;
+    r->features   = p.features;
+    return 0;
+}
+
+/* uring_exit - Unmaps and closes a ring (also drops registered buffers) */
+void uring_exit(uring_t *r) {
+    munmap(r->sqes, r->sq_entries * sizeof(struct io_uring_sqe));
+    munmap(r->ring_ptr, r->ring_len);
+    close(r->ring_fd);
+}
+
+/*
+ * uring_enter - Submits queued SQEs and waits for at least wait_nr CQEs.
+ * With timeout_ms >= 0 the wait is bounded (needs IORING_FEAT_EXT_ARG,
+ * fails with ETIME on expiry); with timeout_ms < 0 it is unbounded.
+ */
+int uring_enter(uring_t *r, unsigned wait_nr, int timeout_ms) {
+    struct __kernel_timespec      ts;
+    struct io_uring_getevents_arg arg;
+    unsigned                      flags = wait_nr ? IORING_ENTER_GETEVENTS : 0;
+    void                         *argp  = NULL;
+    size_t                        argsz = 0;
+
+    if (timeout_ms >= 0) {
+        memset(&arg, 0, sizeof(arg));
+        ts.tv_sec  = timeout_ms / 1000;
+        ts.tv_nsec = (long long)(timeout_ms % 1000) * 1000000LL;
+        arg.ts     = (uint64_t)(uintptr_t)&ts;
+        flags     |= IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG;
+        argp       = &arg;
+        argsz      = sizeof(arg);
+    }
+
+    int ret = (int)syscall(__NR_io_uring_enter, r->ring_fd, r->to_submit, wait_nr,
+                           flags, argp, argsz);
+    if (ret >= 0) r->to_submit -= ((unsigned)ret < r->to_submit) ? (unsigned)ret : r->to_submit;
+    return ret;
+}
+
+/* uring_get_sqe - Returns a zeroed SQE, flushing the SQ first if it is full */
+struct io_uring_sqe *uring_get_sqe(uring_t *r) {
+    unsigned tail = *r->sq_tail;
+    while (tail - __atomic_load_n(r->sq_head, __ATOMIC_ACQUIRE) >= r->sq_entries) {
+        if (uring_enter(r, 0, -1) < 0 && errno != EINTR) return NULL;
+    }
+
+    unsigned             idx = tail & *r->sq_mask;
+    struct io_uring_sqe *sqe = &r->sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    r->sq_array[idx] = idx;
+    __atomic_store_n(r->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    r->to_submit++;
+    return sqe;
+}
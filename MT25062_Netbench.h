@@ -0,0 +1,566 @@
+/*
+ * MT25062_Netbench.h
+ * Netbench Core Library (shared by client and server)
+ * Roll No: MT25062
+ *
+ * Everything both sides of the benchmark agree on lives here: the
+ * config_t handshake, message_t, timing, latency histograms, socket
+ * helpers and a minimal raw-syscall io_uring wrapper. On top of that
+ * it defines the two plug-in points:
+ *
+ *   send_engine_t - one copy strategy on the client (A1..A4). The shared
+ *                   client loop (MT25062_Client.c) connects, times and
+ *                   reports; an engine only moves one message.
+ *   recv_engine_t - one receive strategy on the server (thread, epoll,
+ *                   uring, zerocopy). The shared accept loop
+ *                   (MT25062_Server.c) hands each connection to it.
+ *
+ * Hot-path helpers (timer_now_ns, hist_record) are static inline so the
+ * send loop pays no cross-object call for them.
+ */
+
+#ifndef MT25062_NETBENCH_H
+#define MT25062_NETBENCH_H
+
+#include <stdint.h>
+#include <limits.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <sys/socket.h>
+#include <linux/io_uring.h>
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+/* ========================= Constants ================================= */
+#define SERVER_PORT  8080
+#define NUM_FIELDS   8     /* Number of string fields in message struct */
+#define BACKLOG      64
+
+/* Messages coalesced per send call (-b); each takes up to MSG_IOVS iovecs */
+#ifndef IOV_MAX
+#define IOV_MAX      1024
+#endif
+#define MSG_IOVS     (NUM_FIELDS + 1)   /* frame header + fields */
+#define BATCH_MAX    (IOV_MAX / MSG_IOVS)
+
+/* ========================= Structures ================================ */
+
+/* Configuration sent by the client at connection start */
+typedef struct {
+    int msg_size;   /* Total message size in bytes            */
+    int duration;   /* Test duration in seconds               */
+    int echo;       /* 1 = echo each message back (ping-pong) */
+    int framed;     /* 1 = each message is preceded by frame_hdr_t */
+    int checksum;   /* 1 = frame_hdr_t.crc holds the payload CRC32C */
+} config_t;
+
+/*
+ * Wire header of a framed message (config_t.framed). Framing lets
+ * messages vary in size and lets the server count messages rather than
+ * recv() calls; fields are in host byte order, as config_t is. seq
+ * numbers a connection's messages from 0 so the server can detect gaps
+ * and reordering. ts_ns is the sender's CLOCK_MONOTONIC_RAW just before
+ * the send, giving one-way latency when sender and receiver share that
+ * clock (the same host, e.g. the namespace testbed). With
+ * config_t.checksum, crc is the CRC32C of the payload bytes.
+ */
+typedef struct {
+    uint32_t len;       /* payload bytes that follow the header */
+    uint32_t seq;       /* per-connection message number        */
+    uint64_t ts_ns;     /* send time, CLOCK_MONOTONIC_RAW       */
+    uint32_t crc;       /* payload CRC32C, 0 if unchecked       */
+    uint32_t reserved;  /* zero                                 */
+} frame_hdr_t;
+
+/*
+ * Message structure comprising 8 dynamically allocated string fields.
+ * Each field is heap-allocated via malloc(), or with -H carved back to
+ * back from one hugepage-backed arena (see alloc_message). field_size
+ * is each field's capacity; message_set_size() chooses how many bytes
+ * of each field (field_len) the current message carries.
+ */
+typedef struct {
+    char       *fields[NUM_FIELDS];
+    int         field_size;             /* capacity of each field         */
+    int         field_len[NUM_FIELDS];  /* bytes used in this message     */
+    int         len;                    /* sum of field_len               */
+    int         framed;                 /* send hdr before the fields     */
+    frame_hdr_t hdr;
+    char       *arena;      /* -H: mapping holding all fields, else NULL */
+    size_t      arena_len;
+} message_t;
+
+/*
+ * Log-linear (HDR-style) latency histogram, one per thread. Values are
+ * nanoseconds. Below 2^HIST_SUB_BITS every value has its own bucket;
+ * above, each power of two is split into 2^(HIST_SUB_BITS-1) linear
+ * sub-buckets, bounding relative error to ~3%. Each thread writes only
+ * its own histogram, so recording needs no locks or atomics; main()
+ * merges them after pthread_join().
+ */
+#define HIST_SUB_BITS  6
+#define HIST_HALF      (1 << (HIST_SUB_BITS - 1))
+#define HIST_BUCKETS   ((66 - HIST_SUB_BITS) * HIST_HALF)
+
+typedef struct {
+    unsigned long long counts[HIST_BUCKETS];
+    unsigned long long total;
+    unsigned long long max_ns;
+} latency_hist_t;
+
+/* ========================= Timing Utilities ========================== */
+/*
+ * All timestamps are nanoseconds on CLOCK_MONOTONIC_RAW, which never
+ * steps or slews (gettimeofday() does both). After a successful
+ * timer_calibrate_tsc() on x86-64 CPUs with an invariant TSC,
+ * timer_now_ns() instead reads rdtscp and scales it by a 32.32
+ * fixed-point factor, replacing a vDSO call with ~20 cycles.
+ */
+extern int      g_tsc_enabled;
+extern uint64_t g_tsc_base;     /* TSC reading at calibration       */
+extern uint64_t g_tsc_ns_base;  /* clock reading at calibration     */
+extern uint64_t g_tsc_mult;     /* ns per tick, 32.32 fixed point   */
+
+static inline uint64_t clock_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+#if defined(__x86_64__)
+static inline uint64_t tsc_read(void) {
+    unsigned int aux;
+    return __rdtscp(&aux);
+}
+#endif
+
+/* timer_now_ns - Current monotonic time in nanoseconds */
+static inline uint64_t timer_now_ns(void) {
+#if defined(__x86_64__)
+    if (g_tsc_enabled)
+        return g_tsc_ns_base +
+               (uint64_t)(((unsigned __int128)(tsc_read() - g_tsc_base) * g_tsc_mult) >> 32);
+#endif
+    return clock_now_ns();
+}
+
+/*
+ * thread_cpu_ns - CPU time consumed by the calling thread, user plus
+ * system (syscalls included). Differences over a window give the CPU
+ * cost of the work done in it, busy-waiting included.
+ */
+static inline uint64_t thread_cpu_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+int  timer_calibrate_tsc(void);
+void timer_describe(void);
+
+/* ========================= Latency Histogram ========================= */
+
+/* hist_index - Maps a value to its log-linear bucket */
+static inline int hist_index(unsigned long long v) {
+    if (v < (1ULL << HIST_SUB_BITS)) return (int)v;
+    int shift = (63 - __builtin_clzll(v)) - HIST_SUB_BITS + 1;
+    return shift * HIST_HALF + (int)(v >> shift);
+}
+
+/* hist_record - Records one latency sample given in nanoseconds */
+static inline void hist_record(latency_hist_t *h, unsigned long long ns) {
+    h->counts[hist_index(ns)]++;
+    h->total++;
+    if (ns > h->max_ns) h->max_ns = ns;
+}
+
+void   hist_merge(latency_hist_t *dst, const latency_hist_t *src);
+double hist_percentile_us(const latency_hist_t *h, double p);
+
+/* ========================= Hardware Counters ========================= */
+/*
+ * In-process perf_event_open() counters (-p). Each thread opens its own
+ * set (pid 0, any CPU), so values cover only that thread, and enables
+ * them only around its steady-state loop: connection setup, allocation
+ * and page faulting stay out. Kernel-mode work is included unless
+ * perf_event_paranoid forbids it (user_only). Counters the PMU cannot
+ * provide read as 0; multiplexed counts are scaled to the enabled time.
+ */
+enum {
+    PERF_EV_CYCLES = 0,
+    PERF_EV_INSTRUCTIONS,
+    PERF_EV_L1D_MISSES,       /* L1-dcache-load-misses   */
+    PERF_EV_LLC_MISSES,       /* LLC-load-misses         */
+    PERF_EV_CACHE_REFS,       /* cache-references        */
+    PERF_EV_CACHE_MISSES,     /* cache-misses            */
+    PERF_EV_CTX_SWITCHES,     /* context-switches        */
+    PERF_EV_COUNT
+};
+
+typedef struct {
+    int      fd[PERF_EV_COUNT];     /* -1 if the event is unavailable */
+    uint64_t value[PERF_EV_COUNT];
+    int      user_only;             /* kernel counting not permitted  */
+} perf_counters_t;
+
+extern const char *const perf_event_names[PERF_EV_COUNT];
+
+int  perf_counters_open(perf_counters_t *pc);
+void perf_counters_start(perf_counters_t *pc);
+void perf_counters_stop(perf_counters_t *pc);
+void perf_counters_close(perf_counters_t *pc);
+
+/* ========================= NUMA Placement ============================ */
+/*
+ * Where message buffers live (-N). With the default policy they come
+ * from malloc() and land wherever the allocator's arena pages are. The
+ * other modes mmap() each buffer, mbind() it to one node and fault it
+ * in immediately, so placement does not depend on who touches it first:
+ *   local  - node of the CPU running the allocating thread (pin it
+ *            with -P so that stays true for the whole run)
+ *   remote - the next node after the local one, to measure the
+ *            cross-socket penalty (same as local on single-node hosts)
+ *   <n>    - explicit node n
+ */
+typedef enum { NUMA_DEFAULT = 0, NUMA_LOCAL, NUMA_REMOTE, NUMA_NODE } numa_mode_t;
+
+typedef struct {
+    numa_mode_t mode;
+    int         node;   /* NUMA_NODE only */
+} numa_policy_t;
+
+extern numa_policy_t g_numa;    /* applies to alloc_message and numa_alloc */
+
+int   numa_policy_parse(numa_policy_t *p, const char *spec);
+void  numa_policy_describe(const numa_policy_t *p, const char *who);
+int   numa_current_node(void);
+void *numa_alloc(size_t len);
+void  numa_free(void *ptr, size_t len);
+
+/* ========================= Message / Network / Output ================ */
+#define HUGEPAGE_SIZE  (2UL << 20)
+
+extern int g_hugepages;         /* -H: alloc_message carves from a 2 MiB arena */
+
+message_t *alloc_message(int msg_size);
+void       free_message(message_t *msg);
+void       message_set_size(message_t *msg, int len);
+int        message_iov(message_t *msg, struct iovec *iov);
+
+/* message_wire_len - Bytes one message occupies on the wire */
+static inline size_t message_wire_len(const message_t *msg) {
+    return (size_t)msg->len + (msg->framed ? sizeof(frame_hdr_t) : 0);
+}
+
+/*
+ * Message size distributions (-D). Sizes are drawn per message, capped
+ * at the msg_size argument, and split across the 8 fields.
+ *   fixed               - always msg_size (default)
+ *   uniform:MIN-MAX     - uniform in [MIN, MAX]
+ *   bimodal:S,L,P       - S bytes with probability P%, else L bytes
+ *   zipf:MIN-MAX[,A]    - power-of-two sizes MIN, 2*MIN, ... MAX where
+ *                         rank k has weight 1/k^A (default A = 1):
+ *                         mostly small messages, a tail of large ones
+ *   trace:FILE          - replay sizes from FILE (one per line), each
+ *                         thread starting at a different offset
+ */
+#define SIZE_ZIPF_RANKS  32
+
+typedef enum { SIZE_FIXED = 0, SIZE_UNIFORM, SIZE_BIMODAL, SIZE_ZIPF, SIZE_TRACE } size_mode_t;
+
+typedef struct {
+    size_mode_t mode;
+    int         lo, hi;                 /* uniform/zipf bounds, bimodal S/L */
+    int         pct_lo;                 /* bimodal: % of small messages     */
+    int         nranks;                 /* zipf                             */
+    double      cdf[SIZE_ZIPF_RANKS];
+    int        *trace;
+    long        ntrace;
+} size_dist_t;
+
+typedef struct {
+    const size_dist_t *dist;
+    int                max;     /* msg_size: cap and fixed size */
+    uint64_t           rng;
+    long               pos;     /* trace cursor                 */
+} size_gen_t;
+
+int    size_dist_parse(size_dist_t *d, const char *spec);
+void   size_dist_describe(const size_dist_t *d, int max);
+double size_dist_mean(const size_dist_t *d, int max);
+void   size_gen_init(size_gen_t *g, const size_dist_t *d, int max, uint64_t seed);
+int    size_gen_next(size_gen_t *g);
+
+/*
+ * Open-loop pacing (-O): instead of sending as fast as calls return,
+ * each thread follows a schedule of intended send times at a target
+ * rate, given in messages/sec or (suffix g) Gbit/s and split evenly
+ * across threads. Gaps are constant or exponential (Poisson arrivals).
+ * The schedule never waits for a late send, so latency measured from
+ * the intended time includes queueing behind earlier sends and avoids
+ * coordinated omission.
+ */
+typedef enum { ARRIVAL_CONST = 0, ARRIVAL_POISSON } arrival_mode_t;
+
+typedef struct {
+    double         msgs_per_sec;    /* 0 when paced by bits_per_sec */
+    double         bits_per_sec;
+    arrival_mode_t arrival;
+} pace_spec_t;
+
+typedef struct {
+    const pace_spec_t *spec;
+    double             share;      /* this thread's fraction of the rate */
+    double             next_ns;    /* intended start of the next send    */
+    uint64_t           rng;
+} pacer_t;
+
+int      pace_parse(pace_spec_t *p, const char *spec);
+void     pace_describe(const pace_spec_t *p, int threads);
+void     pacer_init(pacer_t *pc, const pace_spec_t *p, int threads,
+                    uint64_t start_ns, uint64_t seed);
+uint64_t pacer_next(pacer_t *pc, size_t wire_bytes, int msgs);
+void     pace_wait(uint64_t target_ns);
+
+/*
+ * Kernel pacing (-K): the same rate spec is instead handed to the kernel
+ * as each socket's SO_MAX_PACING_RATE. TCP stamps every segment with an
+ * earliest departure time (EDT) from that rate and the fq qdisc holds it
+ * until then, so the sending thread just blocks in send() once its
+ * socket buffer fills rather than sleeping and spinning in user space.
+ */
+double pace_kernel_rate(const pace_spec_t *p, double wire_bytes, int threads);
+int    socket_set_pacing(int sock, double bytes_per_sec);
+
+/*
+ * Payload generators (-G): rewrite a message's fields before every send
+ * so the serialization and copy paths see freshly written data rather
+ * than the cache-hot pattern alloc_message() leaves behind.
+ *   static  - never touch the fields (original behaviour)
+ *   counter - stamp a 64-bit sequence number at the head of each field
+ *   random  - overwrite every byte from a splitmix64 PRNG
+ *   record  - fill fields with 64-byte JSON-like records whose numeric
+ *             columns are formatted per record, as a serializer would
+ */
+typedef enum { PAYLOAD_STATIC = 0, PAYLOAD_COUNTER, PAYLOAD_RANDOM, PAYLOAD_RECORD } payload_mode_t;
+
+typedef struct {
+    payload_mode_t mode;
+    uint64_t       seq;     /* messages generated so far */
+    uint64_t       rng;     /* splitmix64 state          */
+} payload_gen_t;
+
+int         payload_parse(payload_mode_t *mode, const char *spec);
+const char *payload_name(payload_mode_t mode);
+void        payload_init(payload_gen_t *g, payload_mode_t mode, uint64_t seed);
+void        payload_fill(payload_gen_t *g, message_t *msg);
+
+/*
+ * Checksums (-C): CRC32C (Castagnoli) of each message's payload, carried
+ * in the frame header and verified by the server. crc32c_update() chains:
+ * start from 0 and feed the bytes in any number of pieces. It uses the
+ * SSE4.2 crc32 instruction when the CPU has it, else a byte table.
+ */
+uint32_t    crc32c_update(uint32_t crc, const void *data, size_t len);
+const char *crc32c_impl(void);
+uint32_t    message_checksum(const message_t *msg);
+
+ssize_t send_all(int sock, const void *buf, size_t len, int flags);
+ssize_t sendmsg_all(int sock, struct msghdr *mhdr, int flags);
+ssize_t recv_all(int sock, void *buf, size_t len);
+int     connect_to_server(const char *server_ip, int server_port);
+int     create_server_socket(int port, int reuseport);
+
+void print_results(const char *impl, int msg_size, int threads,
+                   long long total_bytes, double elapsed,
+                   double avg_lat, const latency_hist_t *hist,
+                   const perf_counters_t *counters);
+
+/* ========================= CPU Pinning =============================== */
+/*
+ * Thread placement policy (-P). The policy is an ordered CPU list drawn
+ * from the process's allowed set; thread i runs on cpus[i % ncpus].
+ *   compact - fill a core's SMT siblings, then the next core of the same
+ *             package (threads share L1/L2/LLC)
+ *   scatter - one thread per physical core, alternating packages, before
+ *             any SMT sibling is reused (threads share as little as possible)
+ *   list    - explicit CPUs, e.g. "0,2,4-7"
+ */
+#define PIN_MAX_CPUS  1024
+
+typedef enum { PIN_NONE = 0, PIN_COMPACT, PIN_SCATTER, PIN_LIST } pin_mode_t;
+
+typedef struct {
+    pin_mode_t mode;
+    int        ncpus;
+    int        cpus[PIN_MAX_CPUS];
+} cpu_policy_t;
+
+int  cpu_policy_parse(cpu_policy_t *p, const char *spec);
+int  cpu_policy_cpu(const cpu_policy_t *p, int index);
+void cpu_policy_describe(const cpu_policy_t *p, const char *who);
+int  pin_thread_to_cpu(int cpu);
+
+/* ========================= io_uring Ring ============================= */
+/*
+ * Minimal raw-syscall io_uring wrapper (no liburing dependency). Only
+ * the owning thread touches a ring, and without SQPOLL the kernel reads
+ * the SQ only inside io_uring_enter(), so plain release/acquire on the
+ * ring indices is sufficient.
+ */
+typedef struct {
+    int                  ring_fd;
+    unsigned            *sq_head, *sq_tail, *sq_mask, *sq_array;
+    unsigned            *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    unsigned             sq_entries;
+    unsigned             to_submit;
+    unsigned             features;    /* IORING_FEAT_* reported by setup */
+    void                *ring_ptr;
+    size_t               ring_len;
+} uring_t;
+
+int                  uring_init(uring_t *r, unsigned entries);
+void                 uring_exit(uring_t *r);
+int                  uring_enter(uring_t *r, unsigned wait_nr, int timeout_ms);
+struct io_uring_sqe *uring_get_sqe(uring_t *r);
+
+/* ========================= Send Engines (client) ===================== */
+
+/* Per-connection parameters handed to send_engine_t.open */
+typedef struct {
+    int thread_id;
+    int msg_size;
+    int zc_window;      /* zero_copy: max un-notified sends */
+    int zc_ring;        /* zero_copy: rotating buffers, 0 = reuse msg */
+    int batch;          /* messages per send() call, 1..BATCH_MAX */
+} send_opts_t;
+
+/* Completion counters filled in by zero-copy engines on close */
+typedef struct {
+    long long zc_completed;     /* sends covered by notifications        */
+    long long zc_copied;        /* ...of which the kernel copied         */
+    long long zc_window_waits;  /* times the sender blocked on a window  */
+    long long zc_enobufs;       /* ENOBUFS failures                      */
+    long long zc_ring_stalls;   /* waits for a buffer to be released     */
+} send_stats_t;
+
+/*
+ * A send engine moves one message_t per send() call. open() runs after
+ * connect() and before the config_t handshake, so it may still set
+ * socket options; it returns the engine context or NULL on failure.
+ * prepare() (optional) runs outside the timed region; send() is timed
+ * and returns the bytes sent, or -1 with errno set. close() drains any
+ * outstanding completions and frees the context. Engines with
+ * 'batching' set move opts->batch messages per send() call.
+ *
+ * acquire() (optional) returns the message_t the producer may write
+ * next; it is passed on to prepare() and send(). Engines whose sends
+ * keep referencing user memory after returning (zero-copy) use it to
+ * hand out only buffers no in-flight send still points at; it returns
+ * NULL (errno set) if it cannot, which ends the thread's run.
+ */
+typedef struct send_engine {
+    const char *name;       /* -i value and RESULT impl column       */
+    const char *title;      /* banner printed by the client          */
+    int         zerocopy;   /* reports send_stats_t                  */
+    int         batching;   /* honours send_opts_t.batch             */
+    int         hdr_copied; /* frame header is copied at send time,
+                               so it may be rewritten without -R    */
+    void      *(*open)(int sock, message_t *msg, const send_opts_t *opts);
+    message_t *(*acquire)(void *ctx, int sock, message_t *msg);
+    void       (*prepare)(void *ctx, int sock, message_t *msg);
+    ssize_t    (*send)(void *ctx, int sock, message_t *msg);
+    void       (*close)(void *ctx, int sock, send_stats_t *stats);
+} send_engine_t;
+
+extern const send_engine_t engine_two_copy;     /* MT25062_Part_A1_Client.c */
+extern const send_engine_t engine_one_copy;     /* MT25062_Part_A2_Client.c */
+extern const send_engine_t engine_zero_copy;    /* MT25062_Part_A3_Client.c */
+extern const send_engine_t engine_uring_zc;     /* MT25062_Part_A4_Client.c */
+
+/* ========================= Receive Engines (server) ================== */
+
+extern volatile int  g_running;        /* cleared by SIGINT/SIGTERM          */
+extern cpu_policy_t  g_pin;            /* -P: server thread placement        */
+extern int           g_pin_incoming;   /* -I: follow SO_INCOMING_CPU         */
+
+/*
+ * Per-connection receive state. Thread-per-client engines keep one of
+ * these per handler thread; the epoll and uring engines keep one per
+ * socket. total_bytes, recv_calls and msgs have a single writer, the
+ * receiving thread, and are stored atomically so that the -S stats
+ * thread can read them while the session runs.
+ */
+typedef struct conn_state {
+    int                client_fd;
+    int                thread_id;
+    config_t           config;
+    size_t             cfg_received;  /* config_t bytes read so far         */
+    char              *recv_buf;      /* numa_alloc()ed, recv_len bytes    */
+    size_t             recv_len;
+    long long          total_bytes;
+    long long          recv_calls;    /* receives passed to conn_account    */
+    long long          msgs;          /* framed: complete messages          */
+    long long          bad_frames;    /* framed: lengths above msg_size     */
+    frame_hdr_t        hdr;           /* framed: header being reassembled   */
+    size_t             hdr_have;
+    size_t             payload_left;  /* framed: bytes left in this message */
+    uint32_t           next_seq;      /* framed: seq expected next          */
+    long long          seq_missing;   /* framed: seqs skipped (net of late) */
+    long long          seq_reordered; /* framed: seqs below next_seq        */
+    uint64_t           start_ns;      /* session start (conn_start)         */
+    uint64_t           last_ns;       /* framed: last message completed     */
+    uint64_t           owd_total_ns;  /* framed: sum of one-way latencies   */
+    latency_hist_t    *owd;           /* framed: one-way latency histogram  */
+    uint32_t           crc;           /* checksum: CRC of payload so far    */
+    long long          crc_bad;       /* checksum: mismatched messages      */
+    uint64_t           crc_ns;        /* checksum: time spent verifying     */
+    int                live;          /* -S: on the live-session list       */
+    struct conn_state *live_prev, *live_next;
+    long long          stat_bytes;    /* -S: counters at the last report    */
+    long long          stat_calls;
+    long long          stat_msgs;
+    int                queued;        /* epoll: on the worker ready list    */
+    int                dropping;      /* uring: shut down, awaiting EOF CQE */
+    int                echo_handoff;  /* uring: 1 echo seen, 2 recv cancelled */
+    char              *echo_backlog;  /* uring: payload read before handoff */
+    size_t             echo_backlog_len;
+    struct conn_state *next_ready;
+} conn_state_t;
+
+int  conn_start(conn_state_t *c, int need_buf);
+int  conn_recv_config(conn_state_t *c);
+void conn_account(conn_state_t *c, const char *data, size_t len);
+void conn_echo_loop(conn_state_t *c);
+void conn_finish(conn_state_t *c);
+int  conn_spawn(conn_state_t *c, void *(*fn)(void *));
+void conn_pin(conn_state_t *c);
+
+/*
+ * A receive engine takes ownership of accepted connections. start()
+ * (NULL for thread-per-client engines) builds a pool of 'workers'
+ * workers and returns it, or NULL if the engine is unavailable.
+ * add_client() hands a connection to worker 'worker' of the pool and
+ * returns -1 if the caller must close and free it. stop() joins the
+ * workers after g_running is cleared. Pool workers pin themselves to
+ * cpu_policy_cpu(&g_pin, worker index); per-client threads call
+ * conn_pin() once the handshake has arrived.
+ */
+typedef struct recv_engine {
+    const char *name;       /* -m value */
+    void *(*start)(int workers);
+    int   (*add_client)(void *pool, int worker, conn_state_t *c);
+    void  (*stop)(void *pool, int workers);
+} recv_engine_t;
+
+extern const recv_engine_t recv_thread;     /* MT25062_Server_Thread.c   */
+extern const recv_engine_t recv_zerocopy;   /* MT25062_Server_Zerocopy.c */
+extern const recv_engine_t recv_epoll;      /* MT25062_Server_Epoll.c    */
+extern const recv_engine_t recv_uring;      /* MT25062_Server_Uring.c    */
+
+#endif /* MT25062_NETBENCH_H */
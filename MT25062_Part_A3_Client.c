@@ -1,6 +1,6 @@
 /*
  * MT25062_Part_A3_Client.c
- * Zero-Copy TCP Client (Sender Side)
+ * Zero-Copy Send Engine (Sender Side)
  * Roll No: MT25062
  *
  * Part A3: Zero-copy implementation using sendmsg() with MSG_ZEROCOPY.
@@ -19,33 +19,54 @@
  *      via the socket error queue (SO_EE_ORIGIN_ZEROCOPY).
  *   6. Application must drain the error queue to release page pins.
  *
+ * Completion tracking:
+ *   Each successful MSG_ZEROCOPY send is assigned a 32-bit ID by the
+ *   kernel; notifications report an inclusive ID range [ee_info, ee_data].
+ *   The client counts sends and completed IDs to know how many sends are
+ *   in flight, keeps that below a bounded window (-W), and blocks in
+ *   poll(POLLERR) only when the window is full. SO_EE_CODE_ZEROCOPY_COPIED
+ *   ranges are counted to report how often the kernel fell back to copying.
+ *
+ * Rotating buffers (-R N):
+ *   A MSG_ZEROCOPY send keeps referencing its pages until the kernel
+ *   reports completion, so rewriting a buffer that is still in flight
+ *   changes bytes on the wire. Resending one message_t is only safe
+ *   because its payload never changes. With -R the engine owns a ring
+ *   of N message_t buffers; acquire() hands the producer the next slot
+ *   only once the send that last used it has completed, waiting in
+ *   poll(POLLERR) (a "ring stall") if it has not. TCP may complete IDs
+ *   out of order (a retransmit clone can outlive later skbs), so each
+ *   reported range is matched against the slots' send IDs rather than
+ *   assuming everything below a watermark is free. A poll timeout only
+ *   repeats the wait; a socket error ends the run.
+ *
  * Note: MSG_ZEROCOPY has overhead for small messages due to page pinning
  * and completion notification. Benefits appear for large messages (>10KB).
+ * With -H the 8 fields sit back to back in one 2 MiB page, so each send
+ * pins a single compound page instead of up to 8+ separate 4 KiB pages.
  *
  * Requirements: Linux kernel >= 4.14, SO_ZEROCOPY socket option.
  *
- * Usage: ./a3_client <server_ip> <port> <msg_size> <threads> <duration>
+ * Usage: ./netbench_client -i zero_copy [options] <server_ip> <port> <msg_size> <threads> <duration>
+ *        ./a3_client [options] ...  (zero_copy is its default engine)
+ *        Engine options: -W window, -R ring; the rest are common to all engines
+ *        (see MT25062_Client.c).
  */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <unistd.h>
-#include <pthread.h>
 #include <sys/socket.h>
-#include <sys/types.h>
-#include <netinet/in.h>
-#include <netinet/tcp.h>
-#include <arpa/inet.h>
-#include <sys/time.h>
 #include <sys/uio.h>
 #include <errno.h>
-#include <signal.h>
+#include <poll.h>
+#include <netinet/in.h>
 #include <linux/errqueue.h>
 
+#include "MT25062_Netbench.h"
+
 /* ========================= Constants ================================= */
-#define SERVER_PORT  8080
-#define NUM_FIELDS   8
+#define ZC_POLL_MS         1000  /* Max wait for one notification batch     */
 
 /* Fallback definitions for older kernel headers */
 #ifndef SO_ZEROCOPY
@@ -60,107 +81,61 @@
 #define SO_EE_ORIGIN_ZEROCOPY 5
 #endif
 
-/* ========================= Structures ================================ */
-
-typedef struct {
-    int msg_size;
-    int duration;
-} config_t;
+#ifndef SO_EE_CODE_ZEROCOPY_COPIED
+#define SO_EE_CODE_ZEROCOPY_COPIED 1
+#endif
 
+/* ========================= Zero-Copy Completion ===================== */
+/* One rotating buffer: a message and the iovec/msghdr that send it */
 typedef struct {
-    char *fields[NUM_FIELDS];
-    int   field_size;
-} message_t;
+    message_t    *msg;
+    struct iovec  iov[MSG_IOVS];
+    struct msghdr mhdr;
+    unsigned int  id;           /* zero-copy ID of its last send      */
+    int           inflight;     /* id not yet covered by a notification */
+} zc_slot_t;
 
+/*
+ * Per-socket completion tracker. The kernel numbers MSG_ZEROCOPY sends
+ * 0, 1, 2, ... per socket and reports each ID exactly once, though not
+ * necessarily in order; sent - completed is the in-flight count either
+ * way. IDs are 32-bit and wrap, so ranges are computed in unsigned
+ * arithmetic.
+ */
 typedef struct {
-    int       thread_id;
-    char      server_ip[64];
-    int       server_port;
-    int       msg_size;
-    int       duration;
-    long long bytes_transferred;
-    double    elapsed_time;
-    double    avg_latency_us;
-} thread_args_t;
-
-/* ========================= Timing Utilities ========================== */
-
-static double get_time_us(void) {
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    return (double)tv.tv_sec * 1e6 + (double)tv.tv_usec;
-}
-
-static double get_time_sec(void) {
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    return (double)tv.tv_sec + (double)tv.tv_usec / 1e6;
+    unsigned int sent;          /* IDs assigned so far (next ID)          */
+    unsigned int completed;     /* IDs covered by notifications           */
+    long long    total_done;    /* completed, without 32-bit wrap         */
+    long long    copied;        /* IDs in SO_EE_CODE_ZEROCOPY_COPIED ranges */
+    long long    window_waits;
+    long long    enobufs;
+    zc_slot_t   *slots;         /* released as their IDs are reported    */
+    int          nslots;
+} zc_tracker_t;
+
+static unsigned int zc_inflight(const zc_tracker_t *zt) {
+    return zt->sent - zt->completed;
 }
 
-/* ========================= Message Management ======================== */
-
-static message_t *alloc_message(int msg_size) {
-    message_t *msg = (message_t *)malloc(sizeof(message_t));
-    if (!msg) { perror("malloc message_t"); exit(EXIT_FAILURE); }
-
-    msg->field_size = msg_size / NUM_FIELDS;
-    if (msg->field_size <= 0) {
-        fprintf(stderr, "Error: msg_size must be >= %d bytes\n", NUM_FIELDS);
-        exit(EXIT_FAILURE);
+/* zc_release_range - Frees every slot whose send ID lies in [lo, hi] */
+static void zc_release_range(zc_tracker_t *zt, unsigned int lo, unsigned int hi) {
+    for (int i = 0; i < zt->nslots; i++) {
+        zc_slot_t *slot = &zt->slots[i];
+        if (slot->inflight && slot->id - lo <= hi - lo) slot->inflight = 0;
     }
-    for (int i = 0; i < NUM_FIELDS; i++) {
-        msg->fields[i] = (char *)malloc(msg->field_size);
-        if (!msg->fields[i]) { perror("malloc field"); exit(EXIT_FAILURE); }
-        memset(msg->fields[i], 'A' + i, msg->field_size);
-    }
-    return msg;
 }
 
-static void free_message(message_t *msg) {
-    if (!msg) return;
-    for (int i = 0; i < NUM_FIELDS; i++) free(msg->fields[i]);
-    free(msg);
-}
-
-/* ========================= Network Utilities ========================= */
-
-static int connect_to_server(const char *server_ip, int server_port) {
-    int sock = socket(AF_INET, SOCK_STREAM, 0);
-    if (sock < 0) { perror("socket"); return -1; }
-
-    struct sockaddr_in addr;
-    memset(&addr, 0, sizeof(addr));
-    addr.sin_family = AF_INET;
-    addr.sin_port   = htons(server_port);
-    if (inet_pton(AF_INET, server_ip, &addr.sin_addr) <= 0) {
-        perror("inet_pton"); close(sock); return -1;
-    }
-    if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
-        perror("connect"); close(sock); return -1;
-    }
-    return sock;
-}
-
-/* ========================= Output Utilities ========================== */
-
-static void print_results(const char *impl, int msg_size, int threads,
-                           long long total_bytes, double elapsed,
-                           double avg_lat) {
-    double throughput_gbps = (total_bytes * 8.0) / (elapsed * 1e9);
-    printf("RESULT,%s,%d,%d,%.4f,%.2f,%lld,%.4f\n",
-           impl, msg_size, threads, throughput_gbps, avg_lat,
-           total_bytes, elapsed);
-}
-
-/* ========================= Zero-Copy Completion ===================== */
 /*
  * drain_completions - Drain MSG_ZEROCOPY completion notifications.
  *
  * After sendmsg(MSG_ZEROCOPY), the kernel sends completion notifications
  * via the socket's error queue. The application MUST drain these to
- * release pinned user-space pages and avoid resource leaks.
+ * release pinned user-space pages and avoid resource leaks. Each
+ * notification covers the inclusive ID range [ee_info, ee_data]; the
+ * range length is added to the tracker and the slots it covers are
+ * released.
  */
-static void drain_completions(int sock) {
+static void drain_completions(int sock, zc_tracker_t *zt) {
     struct msghdr   msg   = {0};
     char            cbuf[128];
     struct iovec    iov   = {0};
@@ -181,12 +156,18 @@ static void drain_completions(int sock) {
 
         struct cmsghdr *cm = CMSG_FIRSTHDR(&msg);
         while (cm) {
-            if (cm->cmsg_level == SOL_IP &&
-                cm->cmsg_type  == IP_RECVERR) {
+            if ((cm->cmsg_level == SOL_IP   && cm->cmsg_type == IP_RECVERR) ||
+                (cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR)) {
                 struct sock_extended_err *serr;
                 serr = (struct sock_extended_err *)CMSG_DATA(cm);
-                if (serr->ee_origin == SO_EE_ORIGIN_ZEROCOPY) {
-                    /* Zero-copy completion confirmed */
+                if (serr->ee_errno == 0 &&
+                    serr->ee_origin == SO_EE_ORIGIN_ZEROCOPY) {
+                    unsigned int n = serr->ee_data - serr->ee_info + 1;
+                    zt->completed  += n;
+                    zt->total_done += n;
+                    zc_release_range(zt, serr->ee_info, serr->ee_data);
+                    if (serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED)
+                        zt->copied += n;
                 }
             }
             cm = CMSG_NXTHDR(&msg, cm);
@@ -196,193 +177,200 @@ static void drain_completions(int sock) {
     }
 }
 
-/* ========================= Client Thread ============================ */
 /*
- * client_thread - Thread function using sendmsg() with MSG_ZEROCOPY.
- *
- * Key differences from A1/A2:
- *   - Socket has SO_ZEROCOPY enabled.
- *   - sendmsg() called with MSG_ZEROCOPY flag.
- *   - Must drain completion notifications from error queue.
- *   - No user-space copy AND no kernel copy on send path.
+ * wait_completions - Blocks in poll(POLLERR) until the error queue has
+ * notifications (or ZC_POLL_MS passes), then drains it. A pending
+ * socket error or hang-up also wakes poll(); with nothing to drain it
+ * is fetched through SO_ERROR so callers stop waiting on a dead socket.
+ * Returns: 0 if notifications arrived, 1 on timeout, -1 on a socket
+ * error (errno set).
  */
-static void *client_thread(void *arg) {
-    thread_args_t *targs = (thread_args_t *)arg;
+static int wait_completions(int sock, zc_tracker_t *zt) {
+    long long     before = zt->total_done;
+    struct pollfd pfd    = { .fd = sock, .events = POLLERR };
+
+    int ready = poll(&pfd, 1, ZC_POLL_MS);
+    if (ready < 0 && errno != EINTR) return -1;
+    drain_completions(sock, zt);
+    if (zt->total_done != before) return 0;
+    if (ready <= 0 || !(pfd.revents & (POLLERR | POLLHUP | POLLNVAL))) return 1;
+
+    int       err = 0;
+    socklen_t len = sizeof(err);
+    if (getsockopt(sock, SOL_SOCKET, SO_ERROR, &err, &len) < 0) return -1;
+    errno = err ? err : EPIPE;
+    return -1;
+}
 
-    /* --- Step 1: Connect to server --- */
-    int sock = connect_to_server(targs->server_ip, targs->server_port);
-    if (sock < 0) {
-        fprintf(stderr, "[Client T%d] Connection failed\n", targs->thread_id);
-        return NULL;
-    }
+/* ========================= Engine State ============================== */
+typedef struct {
+    zc_slot_t    *slots;        /* slots[0] wraps the client's msg    */
+    int           nslots;       /* 1 without -R                       */
+    int           cur;          /* slot handed out by acquire()       */
+    int           send_flags;   /* MSG_ZEROCOPY, or 0 if unsupported  */
+    unsigned int  window;       /* max in-flight sends (-W)           */
+    long long     ring_stalls;
+    zc_tracker_t  zt;
+} zero_copy_ctx_t;
+
+/* zc_slot_init - Binds a slot to msg and points its iovec at the fields */
+static void zc_slot_init(zc_slot_t *slot, message_t *msg) {
+    slot->msg             = msg;
+    slot->mhdr.msg_iov    = slot->iov;
+    slot->mhdr.msg_iovlen = message_iov(msg, slot->iov);
+}
+
+/*
+ * zero_copy_open - Enables SO_ZEROCOPY and sets up the iovec(s).
+ *
+ * SO_ZEROCOPY must be set before using MSG_ZEROCOPY flag. It tells the
+ * kernel the application will handle page pinning and completion
+ * notifications. If the kernel refuses, the engine degrades to plain
+ * sendmsg() so the run still completes. With -R N, N-1 more messages
+ * are allocated next to the client's to form the rotating ring.
+ */
+static void *zero_copy_open(int sock, message_t *msg, const send_opts_t *opts) {
+    zero_copy_ctx_t *ctx = calloc(1, sizeof(*ctx));
+    if (!ctx) { perror("calloc zero_copy"); return NULL; }
 
-    /* --- Step 2: Enable SO_ZEROCOPY on socket --- */
-    /*
-     * SO_ZEROCOPY must be set before using MSG_ZEROCOPY flag.
-     * Tells the kernel the application will handle page pinning
-     * and completion notifications.
-     */
     int val = 1;
+    ctx->send_flags = MSG_ZEROCOPY;
     if (setsockopt(sock, SOL_SOCKET, SO_ZEROCOPY, &val, sizeof(val)) < 0) {
         perror("setsockopt SO_ZEROCOPY");
         fprintf(stderr, "[Client T%d] Zero-copy not supported, falling back\n",
-                targs->thread_id);
+                opts->thread_id);
+        ctx->send_flags = 0;
     }
-
-    /* --- Step 3: Send configuration to server --- */
-    config_t config;
-    config.msg_size = targs->msg_size;
-    config.duration = targs->duration;
-    if (send(sock, &config, sizeof(config), 0) != sizeof(config)) {
-        fprintf(stderr, "[Client T%d] Failed to send config\n", targs->thread_id);
-        close(sock);
+    ctx->window = (unsigned int)opts->zc_window;
+    ctx->nslots = opts->zc_ring > 0 ? opts->zc_ring : 1;
+    ctx->slots  = calloc(ctx->nslots, sizeof(zc_slot_t));
+    if (!ctx->slots) {
+        perror("calloc zero_copy ring");
+        free(ctx);
         return NULL;
     }
 
-    /* --- Step 4: Allocate message with 8 heap-allocated string fields --- */
-    message_t *msg = alloc_message(targs->msg_size);
-
-    /* --- Step 5: Set up iovec for scatter-gather I/O --- */
-    struct iovec iov[NUM_FIELDS];
-    for (int i = 0; i < NUM_FIELDS; i++) {
-        iov[i].iov_base = msg->fields[i];
-        iov[i].iov_len  = msg->field_size;
-    }
-
-    struct msghdr mhdr;
-    memset(&mhdr, 0, sizeof(mhdr));
-    mhdr.msg_iov    = iov;
-    mhdr.msg_iovlen = NUM_FIELDS;
-
-    /* --- Step 6: Send loop for 'duration' seconds --- */
-    double    start_time    = get_time_sec();
-    long long total_bytes   = 0;
-    long long msg_count     = 0;
-    double    total_latency = 0.0;
-    int       drain_counter = 0;
-
-    while (get_time_sec() - start_time < targs->duration) {
-        /*
-         * ZERO COPY (MSG_ZEROCOPY):
-         * The kernel pins the user-space pages referenced by the iovec
-         * array. It creates sk_buff fragments pointing directly to user
-         * memory. The NIC DMA engine reads from these pages without any
-         * CPU-mediated copy.
-         *
-         * After the NIC finishes DMA, the kernel sends a completion
-         * notification via the socket error queue, allowing the
-         * application to safely modify or free the buffers.
-         *
-         * No user-space copy + no kernel copy = zero copies.
-         */
-        double  msg_start = get_time_us();
-        ssize_t sent      = sendmsg(sock, &mhdr, MSG_ZEROCOPY);
-        double  msg_end   = get_time_us();
-
-        if (sent < 0) {
-            if (errno == ENOBUFS) {
-                /* Kernel ran out of pinnable pages; drain completions */
-                drain_completions(sock);
-                continue;
-            }
-            if (errno == EPIPE || errno == ECONNRESET) break;
-            if (errno == EINTR) continue;
-            perror("sendmsg MSG_ZEROCOPY");
-            break;
-        }
+    zc_slot_init(&ctx->slots[0], msg);
+    for (int i = 1; i < ctx->nslots; i++)
+        zc_slot_init(&ctx->slots[i], alloc_message(opts->msg_size));
+    ctx->zt.slots  = ctx->slots;
+    ctx->zt.nslots = ctx->nslots;
+    return ctx;
+}
 
-        total_bytes   += sent;
-        msg_count     += 1;
-        total_latency += (msg_end - msg_start);
-
-        /*
-         * Periodically drain completion notifications to release
-         * pinned pages and avoid ENOBUFS. Every 64 messages.
-         */
-        if (++drain_counter >= 64) {
-            drain_completions(sock);
-            drain_counter = 0;
+/*
+ * zero_copy_acquire - Hands out the next ring slot (untimed). If the
+ * send that last used it is still in flight, drain notifications until
+ * it completes, counting one ring stall. A poll timeout keeps waiting:
+ * the kernel still has the slot's pages pinned.
+ * Returns: message the producer may overwrite, or NULL on a socket
+ * error (errno set).
+ */
+static message_t *zero_copy_acquire(void *arg, int sock, message_t *msg) {
+    (void)msg;
+    zero_copy_ctx_t *ctx  = (zero_copy_ctx_t *)arg;
+    zc_tracker_t    *zt   = &ctx->zt;
+    ctx->cur = (ctx->cur + 1) % ctx->nslots;
+    zc_slot_t       *slot = &ctx->slots[ctx->cur];
+
+    if (ctx->nslots > 1 && slot->inflight) {
+        ctx->ring_stalls++;
+        drain_completions(sock, zt);
+        while (slot->inflight) {
+            if (wait_completions(sock, zt) < 0) return NULL;
         }
     }
+    return slot->msg;
+}
 
-    /* Final drain of remaining completions */
-    drain_completions(sock);
-
-    double elapsed = get_time_sec() - start_time;
-
-    /* --- Step 7: Record metrics --- */
-    targs->bytes_transferred = total_bytes;
-    targs->elapsed_time      = elapsed;
-    targs->avg_latency_us    = (msg_count > 0) ? (total_latency / msg_count) : 0.0;
-
-    printf("[Client T%d] Sent %lld bytes in %.2f sec (%lld msgs, avg_lat=%.2f us)\n",
-           targs->thread_id, total_bytes, elapsed, msg_count,
-           targs->avg_latency_us);
+/*
+ * zero_copy_prepare - Bounds the in-flight window (untimed). Past half
+ * full, reap whatever has arrived without blocking; when full, sleep in
+ * poll(POLLERR) rather than letting sendmsg() fail with ENOBUFS. On a
+ * socket error it stops waiting and lets send() report the failure. The
+ * slot's iovec is refreshed since field lengths may vary per message.
+ */
+static void zero_copy_prepare(void *arg, int sock, message_t *msg) {
+    zero_copy_ctx_t *ctx = (zero_copy_ctx_t *)arg;
+    zc_tracker_t    *zt  = &ctx->zt;
 
-    free_message(msg);
-    close(sock);
-    return NULL;
-}
+    ctx->slots[ctx->cur].mhdr.msg_iovlen = message_iov(msg, ctx->slots[ctx->cur].iov);
 
-/* ========================= Main ====================================== */
-int main(int argc, char *argv[]) {
-    if (argc < 6) {
-        fprintf(stderr, "Usage: %s <server_ip> <port> <msg_size> <threads> <duration>\n",
-                argv[0]);
-        return EXIT_FAILURE;
+    if (!ctx->send_flags || zc_inflight(zt) < ctx->window / 2) return;
+    drain_completions(sock, zt);
+    while (zc_inflight(zt) >= ctx->window) {
+        zt->window_waits++;
+        if (wait_completions(sock, zt) < 0) return;
     }
+}
 
-    const char *server_ip = argv[1];
-    int         port      = atoi(argv[2]);
-    int         msg_size  = atoi(argv[3]);
-    int         threads   = atoi(argv[4]);
-    int         duration  = atoi(argv[5]);
-
-    printf("[Client] Zero-Copy (MSG_ZEROCOPY) Implementation\n");
-    printf("[Client] Server=%s:%d, MsgSize=%d, Threads=%d, Duration=%d sec\n",
-           server_ip, port, msg_size, threads, duration);
-
-    signal(SIGPIPE, SIG_IGN);
-
-    pthread_t     *tids  = malloc(sizeof(pthread_t)     * threads);
-    thread_args_t *targs = malloc(sizeof(thread_args_t) * threads);
-    if (!tids || !targs) { perror("malloc threads"); return EXIT_FAILURE; }
-
-    for (int i = 0; i < threads; i++) {
-        targs[i].thread_id = i;
-        strncpy(targs[i].server_ip, server_ip, sizeof(targs[i].server_ip) - 1);
-        targs[i].server_ip[sizeof(targs[i].server_ip) - 1] = '\0';
-        targs[i].server_port       = port;
-        targs[i].msg_size          = msg_size;
-        targs[i].duration          = duration;
-        targs[i].bytes_transferred = 0;
-        targs[i].elapsed_time      = 0.0;
-        targs[i].avg_latency_us    = 0.0;
-
-        if (pthread_create(&tids[i], NULL, client_thread, &targs[i]) != 0) {
-            perror("pthread_create");
-            return EXIT_FAILURE;
+/*
+ * zero_copy_send - ZERO COPY (MSG_ZEROCOPY):
+ * The kernel pins the user-space pages referenced by the iovec array.
+ * It creates sk_buff fragments pointing directly to user memory. The
+ * NIC DMA engine reads from these pages without any CPU-mediated copy.
+ *
+ * After the NIC finishes DMA, the kernel sends a completion
+ * notification via the socket error queue, allowing the application to
+ * safely modify or free the buffers.
+ *
+ * No user-space copy + no kernel copy = zero copies.
+ */
+static ssize_t zero_copy_send(void *arg, int sock, message_t *msg) {
+    (void)msg;
+    zero_copy_ctx_t *ctx  = (zero_copy_ctx_t *)arg;
+    zc_slot_t       *slot = &ctx->slots[ctx->cur];
+
+    for (;;) {
+        ssize_t sent = sendmsg(sock, &slot->mhdr, ctx->send_flags);
+        if (sent >= 0) {
+            if (ctx->send_flags) {
+                slot->id       = ctx->zt.sent++;
+                slot->inflight = 1;
+            }
+            return sent;
+        }
+        if (errno == ENOBUFS) {
+            /* Notification memory exhausted: wait, don't spin */
+            ctx->zt.enobufs++;
+            if (wait_completions(sock, &ctx->zt) < 0) return -1;
+            continue;
         }
+        if (errno != EINTR) return -1;
     }
+}
 
-    for (int i = 0; i < threads; i++) pthread_join(tids[i], NULL);
-
-    long long total_bytes   = 0;
-    double    max_elapsed   = 0.0;
-    double    total_latency = 0.0;
+/*
+ * zero_copy_close - Final drain: waits until every send has been
+ * notified, giving up after ZC_POLL_MS without progress or on an error.
+ */
+static void zero_copy_close(void *arg, int sock, send_stats_t *stats) {
+    zero_copy_ctx_t *ctx = (zero_copy_ctx_t *)arg;
+    zc_tracker_t    *zt  = &ctx->zt;
 
-    for (int i = 0; i < threads; i++) {
-        total_bytes   += targs[i].bytes_transferred;
-        total_latency += targs[i].avg_latency_us;
-        if (targs[i].elapsed_time > max_elapsed)
-            max_elapsed = targs[i].elapsed_time;
+    while (ctx->send_flags && zc_inflight(zt) > 0) {
+        if (wait_completions(sock, zt) != 0) break;
     }
 
-    double avg_latency = total_latency / threads;
-    print_results("zero_copy", msg_size, threads,
-                  total_bytes, max_elapsed, avg_latency);
-
-    free(tids);
-    free(targs);
-    return 0;
+    stats->zc_completed    = zt->total_done;
+    stats->zc_copied       = zt->copied;
+    stats->zc_window_waits = zt->window_waits;
+    stats->zc_enobufs      = zt->enobufs;
+    stats->zc_ring_stalls  = ctx->ring_stalls;
+    for (int i = 1; i < ctx->nslots; i++) free_message(ctx->slots[i].msg);
+    free(ctx->slots);
+    free(ctx);
 }
+
+const send_engine_t engine_zero_copy = {
+    .name       = "zero_copy",
+    .title      = "Zero-Copy (MSG_ZEROCOPY)",
+    .zerocopy   = 1,
+    .batching   = 0,
+    .hdr_copied = 0,
+    .open       = zero_copy_open,
+    .acquire    = zero_copy_acquire,
+    .prepare    = zero_copy_prepare,
+    .send       = zero_copy_send,
+    .close      = zero_copy_close,
+};
@@ -0,0 +1,349 @@
+/*
+ * MT25062_Part_A4_Client.c
+ * io_uring Zero-Copy Send Engine (Sender Side)
+ * Roll No: MT25062
+ *
+ * Part A4: Zero-copy implementation using io_uring IORING_OP_SEND_ZC.
+ *
+ * Like A3, the kernel transmits directly from pinned user pages, but:
+ *   1. The 8 message_t fields are registered once with the ring
+ *      (IORING_REGISTER_BUFFERS), so pages are pinned up front instead
+ *      of by get_user_pages() on every send.
+ *   2. Each message is submitted as 8 linked SEND_ZC SQEs (one per
+ *      field) with a single io_uring_enter() call.
+ *   3. Buffer-release notifications arrive as IORING_CQE_F_NOTIF CQEs
+ *      in the completion queue instead of on the socket error queue,
+ *      so no recvmsg(MSG_ERRQUEUE) polling and no ENOBUFS stalls.
+ *
+ * Latency is measured from submission of a message's SQEs until all 8
+ * send CQEs have been reaped, mirroring sendmsg() return time in A3.
+ *
+ * Rotating buffers (-R N): as in A3, a buffer may not be rewritten while
+ * the kernel still references its pages. With -R the engine owns N
+ * message_t buffers (all registered); acquire() hands out the next one
+ * only once every notification owed for its last send has been reaped,
+ * waiting on the ring (a "ring stall") if not. Each SQE's user_data
+ * carries its slot, so notifications are credited to the right buffer.
+ *
+ * Requirements: Linux kernel >= 6.0 (IORING_OP_SEND_ZC). Counting copy
+ * fallbacks needs IORING_SEND_ZC_REPORT_USAGE (>= 6.2); older kernels
+ * reject it with EINVAL, so open() probes once and drops the flag.
+ *
+ * Usage: ./netbench_client -i uring_zc [options] <server_ip> <port> <msg_size> <threads> <duration>
+ *        ./a4_client [options] ...  (uring_zc is its default engine)
+ *        Engine options: -R ring; the rest are common to all engines
+ *        (see MT25062_Client.c).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <errno.h>
+#include <sys/socket.h>
+
+#include "MT25062_Netbench.h"
+
+/* ========================= Constants ================================= */
+#define URING_ENTRIES  64    /* SQ depth; one message uses up to MSG_IOVS SQEs */
+#define SLOT_SHIFT     8     /* user_data = slot << SLOT_SHIFT | SQE index */
+
+/* ========================= Zero-Copy Completion ====================== */
+/*
+ * Per-thread completion bookkeeping. A SEND_ZC request produces a
+ * result CQE (IORING_CQE_F_MORE set when a notification will follow)
+ * and later a notification CQE (IORING_CQE_F_NOTIF) once the kernel no
+ * longer references the pages. With IORING_SEND_ZC_REPORT_USAGE the
+ * notification also tells us whether the kernel fell back to copying.
+ */
+typedef struct {
+    int       sends_done;     /* result CQEs reaped for current message */
+    long long sent_bytes;     /* bytes acknowledged for current message */
+    int       error;          /* first negative result, 0 if none       */
+    long long notifs_pending; /* notifications still owed by the kernel */
+    long long notifs;         /* notifications reaped                   */
+    long long zc_copied;      /* notifications reporting a copy fallback */
+} zc_state_t;
+
+/* One rotating buffer and the notifications still owed for its sends */
+typedef struct {
+    message_t *msg;
+    int        notifs_pending;
+} uring_slot_t;
+
+/*
+ * reap_completions - Consumes all available CQEs into 'st', crediting
+ * each notification to the slot named in its user_data. A notification
+ * always follows its request's F_MORE result CQE, so the per-slot count
+ * never goes negative.
+ */
+static void reap_completions(uring_t *r, zc_state_t *st, uring_slot_t *slots) {
+    unsigned head = *r->cq_head;
+    unsigned tail = __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE);
+
+    for (; head != tail; head++) {
+        struct io_uring_cqe *cqe  = &r->cqes[head & *r->cq_mask];
+        uring_slot_t        *slot = &slots[cqe->user_data >> SLOT_SHIFT];
+
+        if (cqe->flags & IORING_CQE_F_NOTIF) {
+            st->notifs_pending--;
+            slot->notifs_pending--;
+            st->notifs++;
+            if ((unsigned)cqe->res & IORING_NOTIF_USAGE_ZC_COPIED) st->zc_copied++;
+            continue;
+        }
+        if (cqe->flags & IORING_CQE_F_MORE) {
+            st->notifs_pending++;
+            slot->notifs_pending++;
+        }
+
+        st->sends_done++;
+        if (cqe->res < 0) {
+            /* Prefer the real failure over -ECANCELED from broken links */
+            if (!st->error || st->error == ECANCELED) st->error = -cqe->res;
+        } else {
+            st->sent_bytes += cqe->res;
+        }
+    }
+    __atomic_store_n(r->cq_head, head, __ATOMIC_RELEASE);
+}
+
+/* ========================= Engine State ============================== */
+typedef struct {
+    uring_t       ring;
+    int           fixed;        /* fields registered with the ring    */
+    unsigned      zc_flags;     /* REPORT_USAGE, or 0 if unsupported  */
+    uring_slot_t *slots;        /* slots[0] wraps the client's msg    */
+    int           nslots;       /* 1 without -R                       */
+    int           cur;          /* slot handed out by acquire()       */
+    long long     ring_stalls;
+    zc_state_t    st;
+} uring_zc_ctx_t;
+
+/*
+ * uring_zc_probe - Submits one empty SEND_ZC asking for
+ * IORING_SEND_ZC_REPORT_USAGE and waits for its result and notification.
+ * Kernels before 6.2 fail it with EINVAL at prep time, before anything
+ * reaches the socket; the flag is then dropped for the run and copy
+ * fallbacks go uncounted. The probe is left out of the statistics.
+ * Returns: 0 once the probe has completed, -1 if the ring fails.
+ */
+static int uring_zc_probe(uring_zc_ctx_t *ctx, int sock, int thread_id) {
+    zc_state_t          *st  = &ctx->st;
+    struct io_uring_sqe *sqe = uring_get_sqe(&ctx->ring);
+    if (!sqe) { errno = EBUSY; return -1; }
+
+    sqe->opcode    = IORING_OP_SEND_ZC;
+    sqe->fd        = sock;
+    sqe->addr      = (uint64_t)(uintptr_t)ctx->slots[0].msg->fields[0];
+    sqe->len       = 0;
+    sqe->ioprio    = IORING_SEND_ZC_REPORT_USAGE;
+    sqe->user_data = 0;             /* slot 0 */
+
+    st->sends_done = 0;
+    while (st->sends_done < 1 || st->notifs_pending > 0) {
+        if (uring_enter(&ctx->ring, 1, -1) < 0 && errno != EINTR) return -1;
+        reap_completions(&ctx->ring, st, ctx->slots);
+    }
+
+    ctx->zc_flags = IORING_SEND_ZC_REPORT_USAGE;
+    if (st->error == EINVAL) {
+        ctx->zc_flags = 0;
+        fprintf(stderr, "[Client T%d] SEND_ZC usage reports need Linux 6.2; "
+                "copy fallbacks not counted\n", thread_id);
+    }
+    memset(st, 0, sizeof(*st));
+    return 0;
+}
+
+/*
+ * uring_zc_open - Creates the ring and registers the 8 fields of every
+ * slot (slot s, field i is buffer s * NUM_FIELDS + i). If registration
+ * fails (e.g. RLIMIT_MEMLOCK) the engine still works with unregistered
+ * buffers, pinning pages per send like A3. With -R N, N-1 more messages
+ * are allocated next to the client's to form the rotating ring.
+ */
+static void *uring_zc_open(int sock, message_t *msg, const send_opts_t *opts) {
+    uring_zc_ctx_t *ctx = calloc(1, sizeof(*ctx));
+    if (!ctx) { perror("calloc uring_zc"); return NULL; }
+
+    ctx->nslots = opts->zc_ring > 0 ? opts->zc_ring : 1;
+    ctx->slots  = calloc(ctx->nslots, sizeof(uring_slot_t));
+    if (!ctx->slots) {
+        perror("calloc uring_zc ring");
+        free(ctx);
+        return NULL;
+    }
+    ctx->slots[0].msg = msg;
+    for (int s = 1; s < ctx->nslots; s++)
+        ctx->slots[s].msg = alloc_message(opts->msg_size);
+
+    if (uring_init(&ctx->ring, URING_ENTRIES) < 0) {
+        perror("io_uring_setup");
+        for (int s = 1; s < ctx->nslots; s++) free_message(ctx->slots[s].msg);
+        free(ctx->slots);
+        free(ctx);
+        return NULL;
+    }
+
+    int           nbufs = ctx->nslots * NUM_FIELDS;
+    struct iovec *iov   = calloc(nbufs, sizeof(*iov));
+    ctx->fixed = iov != NULL;
+    for (int s = 0; iov && s < ctx->nslots; s++) {
+        for (int i = 0; i < NUM_FIELDS; i++) {
+            iov[s * NUM_FIELDS + i].iov_base = ctx->slots[s].msg->fields[i];
+            iov[s * NUM_FIELDS + i].iov_len  = ctx->slots[s].msg->field_size;
+        }
+    }
+    if (iov && syscall(__NR_io_uring_register, ctx->ring.ring_fd,
+                       IORING_REGISTER_BUFFERS, iov, nbufs) < 0) {
+        perror("io_uring_register buffers");
+        fprintf(stderr, "[Client T%d] Using unregistered buffers\n", opts->thread_id);
+        ctx->fixed = 0;
+    }
+    free(iov);
+
+    if (uring_zc_probe(ctx, sock, opts->thread_id) < 0) {
+        perror("io_uring_enter probe");
+        uring_exit(&ctx->ring);
+        for (int s = 1; s < ctx->nslots; s++) free_message(ctx->slots[s].msg);
+        free(ctx->slots);
+        free(ctx);
+        return NULL;
+    }
+    return ctx;
+}
+
+/*
+ * uring_zc_acquire - Hands out the next ring slot (untimed). If the
+ * kernel still owes notifications for the slot's last send, wait on the
+ * ring until they arrive, counting one ring stall. The slot is never
+ * handed out early: the kernel may still be reading its pages.
+ * Returns: message the producer may overwrite, or NULL if the ring
+ * fails (errno set).
+ */
+static message_t *uring_zc_acquire(void *arg, int sock, message_t *msg) {
+    (void)sock;
+    (void)msg;
+    uring_zc_ctx_t *ctx  = (uring_zc_ctx_t *)arg;
+    ctx->cur = (ctx->cur + 1) % ctx->nslots;
+    uring_slot_t   *slot = &ctx->slots[ctx->cur];
+
+    if (ctx->nslots > 1 && slot->notifs_pending > 0) {
+        ctx->ring_stalls++;
+        reap_completions(&ctx->ring, &ctx->st, ctx->slots);
+        while (slot->notifs_pending > 0) {
+            if (uring_enter(&ctx->ring, 1, -1) < 0 && errno != EINTR) return NULL;
+            reap_completions(&ctx->ring, &ctx->st, ctx->slots);
+        }
+    }
+    return slot->msg;
+}
+
+/*
+ * uring_zc_send - ZERO COPY (SEND_ZC):
+ * Each field is sent straight from its registered pages. The SQEs are
+ * linked so the sends hit the TCP stream in order; one io_uring_enter()
+ * submits them and the loop returns once every result CQE is reaped,
+ * mirroring sendmsg() return time in A3. MSG_WAITALL makes the kernel
+ * finish a short send itself; otherwise the next linked send would
+ * start after a gap in the stream. A frame header is sent with a
+ * plain (copying) IORING_OP_SEND: the 24-byte frame_hdr_t is far too
+ * small for zero-copy to pay off, and its seq, send time and CRC are
+ * rewritten for the next message, possibly before a zero-copy
+ * notification could arrive. The copy makes it safe to reuse at once.
+ */
+static ssize_t uring_zc_send(void *arg, int sock, message_t *msg) {
+    uring_zc_ctx_t *ctx  = (uring_zc_ctx_t *)arg;
+    zc_state_t     *st   = &ctx->st;
+    int             slot = ctx->cur;
+
+    /* Frame header (copied), then each non-empty field */
+    const void *bufs[MSG_IOVS];
+    unsigned    lens[MSG_IOVS];
+    int         fixed_idx[MSG_IOVS];
+    int         n = 0;
+    if (msg->framed) {
+        bufs[n] = &msg->hdr; lens[n] = sizeof(msg->hdr); fixed_idx[n++] = -1;
+    }
+    for (int i = 0; i < NUM_FIELDS; i++) {
+        if (msg->field_len[i] == 0) continue;
+        bufs[n] = msg->fields[i]; lens[n] = msg->field_len[i];
+        fixed_idx[n++] = ctx->fixed ? slot * NUM_FIELDS + i : -1;
+    }
+
+    struct io_uring_sqe *prev = NULL;
+    for (int i = 0; i < n; i++) {
+        struct io_uring_sqe *sqe = uring_get_sqe(&ctx->ring);
+        if (!sqe) {
+            /* SQ full and could not be flushed: end the chain, fail the send */
+            if (prev) prev->flags &= ~IOSQE_IO_LINK;
+            errno = EBUSY;
+            return -1;
+        }
+        prev = sqe;
+        int hdr = (bufs[i] == &msg->hdr);
+        sqe->opcode    = hdr ? IORING_OP_SEND : IORING_OP_SEND_ZC;
+        sqe->fd        = sock;
+        sqe->addr      = (uint64_t)(uintptr_t)bufs[i];
+        sqe->len       = lens[i];
+        sqe->ioprio    = hdr ? 0 : ctx->zc_flags |
+                         (fixed_idx[i] >= 0 ? IORING_RECVSEND_FIXED_BUF : 0);
+        sqe->buf_index = fixed_idx[i] >= 0 ? fixed_idx[i] : 0;
+        sqe->msg_flags = MSG_WAITALL;   /* retry short sends: no gaps */
+        sqe->flags     = (i < n - 1) ? IOSQE_IO_LINK : 0;
+        sqe->user_data = (uint64_t)slot << SLOT_SHIFT | (uint64_t)i;
+    }
+
+    st->sends_done = 0;
+    st->sent_bytes = 0;
+    while (st->sends_done < n) {
+        if (uring_enter(&ctx->ring, 1, -1) < 0 && errno != EINTR) {
+            st->error = errno;
+            break;
+        }
+        reap_completions(&ctx->ring, st, ctx->slots);
+    }
+
+    if (st->error) {
+        errno = st->error;
+        return -1;
+    }
+    return st->sent_bytes;
+}
+
+/* uring_zc_close - Waits for outstanding notifications, then frees the ring */
+static void uring_zc_close(void *arg, int sock, send_stats_t *stats) {
+    (void)sock;
+    uring_zc_ctx_t *ctx = (uring_zc_ctx_t *)arg;
+    zc_state_t     *st  = &ctx->st;
+
+    /* The kernel may still reference the pages until every notification */
+    while (st->notifs_pending > 0) {
+        if (uring_enter(&ctx->ring, 1, -1) < 0 && errno != EINTR) break;
+        reap_completions(&ctx->ring, st, ctx->slots);
+    }
+
+    stats->zc_completed   = st->notifs;
+    stats->zc_copied      = st->zc_copied;
+    stats->zc_ring_stalls = ctx->ring_stalls;
+    uring_exit(&ctx->ring);
+    for (int s = 1; s < ctx->nslots; s++) free_message(ctx->slots[s].msg);
+    free(ctx->slots);
+    free(ctx);
+}
+
+const send_engine_t engine_uring_zc = {
+    .name       = "uring_zc",
+    .title      = "io_uring Zero-Copy (SEND_ZC)",
+    .zerocopy   = 1,
+    .batching   = 0,
+    .hdr_copied = 1,
+    .open       = uring_zc_open,
+    .acquire    = uring_zc_acquire,
+    .prepare    = NULL,
+    .send       = uring_zc_send,
+    .close      = uring_zc_close,
+};
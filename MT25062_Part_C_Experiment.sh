@@ -6,16 +6,22 @@
 #
 # This script:
 #   1. Sets up network namespaces (ns_server, ns_client) with a veth pair.
-#   2. Compiles all three implementations (A1, A2, A3).
+#   2. Compiles all implementations (A1, A2, A3, A4).
 #   3. Runs experiments across message sizes and thread counts.
-#   4. Collects perf stat profiling output automatically.
+#   4. Collects hardware counters for the steady-state send loop with the
+#      client's in-process perf_event counters (-p), so connection setup,
+#      allocation and thread creation are not counted.
 #   5. Stores results in CSV format.
+#   6. Compares user-space pacing (-O) with kernel pacing (-K, enforced by
+#      the fq qdisc on veth_cli) at one rate: throughput and client CPU
+#      time per byte for each engine.
 #
 # No manual intervention required after script starts.
 # Re-running the script will clean up and restart experiments.
 #
 # Usage: sudo bash MT25062_Part_C_Experiment.sh
-# Note:  Requires root privileges for network namespace management and perf.
+# Note:  Requires root privileges for network namespace management (and,
+#        under perf_event_paranoid >= 2, for kernel-mode counts).
 
 # NOTE: Removed 'set -e' because background server processes launched via
 # 'sudo ip netns exec' cause PID tracking issues that trigger false errors.
@@ -24,20 +30,35 @@
 SERVER_IP="10.0.0.1"
 CLIENT_IP="10.0.0.2"
 PORT=8080
-DURATION=2          # seconds per experiment
+DURATION=2          # measured seconds per experiment
+WARMUP=1            # unmeasured seconds before (slow start, page faults)
+COOLDOWN=0          # unmeasured seconds after
 WAIT_SERVER=2          # seconds to wait for server startup
 
 # Experiment parameters (at least 4 each as required)
 MSG_SIZES=(256 1024 4096 16384 65536)
 THREAD_COUNTS=(1 2 4 8)
 
-# Implementation names and binaries
-IMPLS=("two_copy" "one_copy" "zero_copy")
-SERVER_BINS=("a1_server" "a2_server" "a3_server")
-CLIENT_BINS=("a1_client" "a2_client" "a3_client")
+# Implementations are send engines of one client; one server serves all
+IMPLS=("two_copy" "one_copy" "zero_copy" "uring_zc")
+SERVER_BIN="netbench_server"
+CLIENT_BIN="netbench_client"
+
+# Thread placement (-P compact|scatter|cpu-list, "" = scheduler decides).
+# Pinning keeps the perf cache-miss counters reproducible across runs;
+# use disjoint CPU lists to keep client and server off each other's cores.
+CLIENT_PIN="compact"
+SERVER_PIN="compact"
+
+# Pacing comparison: one offered rate, user-space (-O) vs kernel (-K)
+PACE_RATE="2g"          # RATE msgs/sec or RATEg Gbit/s, all threads
+PACE_MSG_SIZE=16384
+PACE_THREADS=2
+PACE_MODES=("user" "kernel")
 
 # Output files
 CSV_FILE="MT25062_Part_B_Results.csv"
+PACE_CSV="MT25062_Part_C_Pacing.csv"
 PERF_DIR="perf_output"
 
 # ========================= Utility Functions ==========================
@@ -49,7 +70,7 @@ log_error() { echo "[ERROR] $(date '+%H:%M:%S') $*" >&2; }
 cleanup() {
     log_info "Cleaning up network namespaces and processes..."
     # Kill any leftover server processes
-    sudo ip netns exec ns_server kill -9 $(sudo ip netns exec ns_server pgrep -f "a[123]_server" 2>/dev/null) 2>/dev/null || true
+    sudo ip netns exec ns_server kill -9 $(sudo ip netns exec ns_server pgrep -f "${SERVER_BIN}" 2>/dev/null) 2>/dev/null || true
     # Delete namespaces (also removes veth pair)
     sudo ip netns del ns_server 2>/dev/null || true
     sudo ip netns del ns_client 2>/dev/null || true
@@ -84,6 +105,12 @@ setup_namespaces() {
     sudo ip netns exec ns_client ip link set veth_cli up
     sudo ip netns exec ns_client ip link set lo up
 
+    # fq holds each paced segment until its earliest departure time, so
+    # SO_MAX_PACING_RATE (-K) costs no per-socket timers in TCP itself
+    if ! sudo ip netns exec ns_client tc qdisc replace dev veth_cli root fq; then
+        log_error "Could not install fq on veth_cli; -K falls back to TCP's internal pacing"
+    fi
+
     # Verify connectivity
     if sudo ip netns exec ns_client ping -c 1 -W 2 ${SERVER_IP} > /dev/null 2>&1; then
         log_info "Network namespaces configured successfully."
@@ -110,48 +137,47 @@ run_experiment() {
     local msg_size=$2
     local threads=$3
     local impl_name="${IMPLS[$impl_idx]}"
-    local server_bin="${SERVER_BINS[$impl_idx]}"
-    local client_bin="${CLIENT_BINS[$impl_idx]}"
-    local perf_file="${PERF_DIR}/${impl_name}_msg${msg_size}_thr${threads}_perf.txt"
+    local perf_file="${PERF_DIR}/${impl_name}_msg${msg_size}_thr${threads}_client.txt"
 
     log_info "Running: impl=${impl_name}, msg_size=${msg_size}, threads=${threads}"
 
     # Start server in ns_server namespace (background)
-    sudo ip netns exec ns_server ./${server_bin} ${PORT} > /dev/null 2>&1 &
+    sudo ip netns exec ns_server ./${SERVER_BIN} ${SERVER_PIN:+-P ${SERVER_PIN}} ${PORT} > /dev/null 2>&1 &
     sleep ${WAIT_SERVER}
 
     # Verify server is running inside the namespace
-    if ! sudo ip netns exec ns_server pgrep -f "${server_bin}" > /dev/null 2>&1; then
+    if ! sudo ip netns exec ns_server pgrep -f "${SERVER_BIN}" > /dev/null 2>&1; then
         log_error "Server failed to start for ${impl_name}"
         return 1
     fi
 
-    # Run client in ns_client namespace with perf stat
-    # Capture perf output to file and client output to variable
+    # Run client in ns_client namespace with in-process counters (-p)
+    # Keep the full client log and the RESULT line
     local client_output
     client_output=$(sudo ip netns exec ns_client \
-        perf stat -e cycles,cache-references,cache-misses,L1-dcache-load-misses,LLC-load-misses,context-switches \
-        -o "${perf_file}" \
-        ./${client_bin} ${SERVER_IP} ${PORT} ${msg_size} ${threads} ${DURATION} 2>&1 | \
-        grep "^RESULT" || echo "RESULT,${impl_name},${msg_size},${threads},0,0,0,0")
+        ./${CLIENT_BIN} -p -w ${WARMUP} -c ${COOLDOWN} -i ${impl_name} ${CLIENT_PIN:+-P ${CLIENT_PIN}} ${SERVER_IP} ${PORT} ${msg_size} ${threads} ${DURATION} 2>&1 | \
+        tee "${perf_file}" | grep "^RESULT" || \
+        echo "RESULT,${impl_name},${msg_size},${threads},0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0")
 
     # Wait briefly for output flush
     sleep 1
 
     # Kill server inside the namespace
-    sudo ip netns exec ns_server pkill -TERM -f "${server_bin}" 2>/dev/null || true
+    sudo ip netns exec ns_server pkill -TERM -f "${SERVER_BIN}" 2>/dev/null || true
     sleep 1
 
-    # Parse perf output
-    local cycles=$(grep "cycles" "${perf_file}" 2>/dev/null | head -1 | awk '{gsub(/,/,"",$1); print $1}')
-    local cache_refs=$(grep "cache-references" "${perf_file}" 2>/dev/null | head -1 | awk '{gsub(/,/,"",$1); print $1}')
-    local cache_misses=$(grep "cache-misses" "${perf_file}" 2>/dev/null | head -1 | awk '{gsub(/,/,"",$1); print $1}')
-    local l1_misses=$(grep "L1-dcache-load-misses" "${perf_file}" 2>/dev/null | head -1 | awk '{gsub(/,/,"",$1); print $1}')
-    local llc_misses=$(grep "LLC-load-misses" "${perf_file}" 2>/dev/null | head -1 | awk '{gsub(/,/,"",$1); print $1}')
-    local ctx_switches=$(grep "context-switches" "${perf_file}" 2>/dev/null | head -1 | awk '{gsub(/,/,"",$1); print $1}')
+    # Parse counter columns of the RESULT line (send loop only)
+    local cycles=$(echo "${client_output}" | awk -F',' '{print $14}')
+    local instructions=$(echo "${client_output}" | awk -F',' '{print $15}')
+    local l1_misses=$(echo "${client_output}" | awk -F',' '{print $16}')
+    local llc_misses=$(echo "${client_output}" | awk -F',' '{print $17}')
+    local cache_refs=$(echo "${client_output}" | awk -F',' '{print $18}')
+    local cache_misses=$(echo "${client_output}" | awk -F',' '{print $19}')
+    local ctx_switches=$(echo "${client_output}" | awk -F',' '{print $20}')
 
     # Set defaults for missing values
     cycles=${cycles:-0}
+    instructions=${instructions:-0}
     cache_refs=${cache_refs:-0}
     cache_misses=${cache_misses:-0}
     l1_misses=${l1_misses:-0}
@@ -163,16 +189,60 @@ run_experiment() {
     local latency=$(echo "${client_output}" | awk -F',' '{print $6}')
     local total_bytes=$(echo "${client_output}" | awk -F',' '{print $7}')
     local elapsed=$(echo "${client_output}" | awk -F',' '{print $8}')
+    local p50=$(echo "${client_output}" | awk -F',' '{print $9}')
+    local p90=$(echo "${client_output}" | awk -F',' '{print $10}')
+    local p99=$(echo "${client_output}" | awk -F',' '{print $11}')
+    local p999=$(echo "${client_output}" | awk -F',' '{print $12}')
+    local max_lat=$(echo "${client_output}" | awk -F',' '{print $13}')
 
     throughput=${throughput:-0}
     latency=${latency:-0}
     total_bytes=${total_bytes:-0}
     elapsed=${elapsed:-0}
+    p50=${p50:-0}
+    p90=${p90:-0}
+    p99=${p99:-0}
+    p999=${p999:-0}
+    max_lat=${max_lat:-0}
 
     # Write to CSV
-    echo "${impl_name},${msg_size},${threads},${throughput},${latency},${cycles},${l1_misses},${llc_misses},${cache_refs},${cache_misses},${ctx_switches},${total_bytes},${elapsed}" >> "${CSV_FILE}"
+    echo "${impl_name},${msg_size},${threads},${throughput},${latency},${cycles},${l1_misses},${llc_misses},${cache_refs},${cache_misses},${ctx_switches},${total_bytes},${elapsed},${p50},${p90},${p99},${p999},${max_lat},${instructions}" >> "${CSV_FILE}"
+
+    log_info "  Throughput=${throughput} Gbps, Latency=${latency} us (p99=${p99} us), Cycles=${cycles}"
+}
+
+# run_pacing_experiment - Run one engine at PACE_RATE under one pacer
+# Args: $1=impl_name, $2=user|kernel
+run_pacing_experiment() {
+    local impl_name=$1
+    local mode=$2
+    local pace_flag="-O"
+    [ "${mode}" = "kernel" ] && pace_flag="-K"
+    local log_file="${PERF_DIR}/${impl_name}_pace_${mode}_client.txt"
+
+    log_info "Pacing: impl=${impl_name}, pacer=${mode}, rate=${PACE_RATE}"
+
+    sudo ip netns exec ns_server ./${SERVER_BIN} ${SERVER_PIN:+-P ${SERVER_PIN}} ${PORT} > /dev/null 2>&1 &
+    sleep ${WAIT_SERVER}
+
+    sudo ip netns exec ns_client \
+        ./${CLIENT_BIN} ${pace_flag} ${PACE_RATE} -w ${WARMUP} -c ${COOLDOWN} -i ${impl_name} \
+        ${CLIENT_PIN:+-P ${CLIENT_PIN}} ${SERVER_IP} ${PORT} ${PACE_MSG_SIZE} ${PACE_THREADS} ${DURATION} \
+        > "${log_file}" 2>&1
 
-    log_info "  Throughput=${throughput} Gbps, Latency=${latency} us, Cycles=${cycles}"
+    sleep 1
+    sudo ip netns exec ns_server pkill -TERM -f "${SERVER_BIN}" 2>/dev/null || true
+    sleep 1
+
+    # "[Client] CPU: X ns/byte sent, Y% of a core per thread ..."
+    local throughput=$(grep "^RESULT" "${log_file}" | awk -F',' '{print $5}')
+    local p99=$(grep "^RESULT" "${log_file}" | awk -F',' '{print $11}')
+    local ns_per_byte=$(grep "^\[Client\] CPU:" "${log_file}" | awk '{print $3}')
+    local core_pct=$(grep "^\[Client\] CPU:" "${log_file}" | awk '{print $6}' | tr -d '%')
+
+    echo "${impl_name},${mode},${PACE_RATE},${PACE_MSG_SIZE},${PACE_THREADS},${throughput:-0},${ns_per_byte:-0},${core_pct:-0},${p99:-0}" >> "${PACE_CSV}"
+
+    log_info "  Throughput=${throughput:-0} Gbps, CPU=${ns_per_byte:-0} ns/byte (${core_pct:-0}% of a core per thread)"
 }
 
 # ========================= Main ======================================
@@ -189,23 +259,17 @@ main() {
         exit 1
     fi
 
-    # Check for perf availability
-    if ! command -v perf &> /dev/null; then
-        log_error "'perf' tool not found. Install with: sudo apt install linux-tools-common linux-tools-\$(uname -r)"
-        exit 1
-    fi
-
     # Compile all implementations
     compile_all
 
     # Set up network namespaces
     setup_namespaces
 
-    # Create perf output directory
+    # Create directory for per-experiment client logs
     mkdir -p "${PERF_DIR}"
 
     # Initialize CSV file with header
-    echo "implementation,msg_size,threads,throughput_gbps,latency_us,cpu_cycles,l1_cache_misses,llc_cache_misses,cache_references,cache_misses,context_switches,total_bytes,elapsed_sec" > "${CSV_FILE}"
+    echo "implementation,msg_size,threads,throughput_gbps,latency_us,cpu_cycles,l1_cache_misses,llc_cache_misses,cache_references,cache_misses,context_switches,total_bytes,elapsed_sec,p50_us,p90_us,p99_us,p999_us,max_latency_us,instructions" > "${CSV_FILE}"
 
     # Total experiments count
     local total_exp=$(( ${#IMPLS[@]} * ${#MSG_SIZES[@]} * ${#THREAD_COUNTS[@]} ))
@@ -214,7 +278,7 @@ main() {
     log_info "Running ${total_exp} experiments..."
     log_info "Message sizes: ${MSG_SIZES[*]}"
     log_info "Thread counts: ${THREAD_COUNTS[*]}"
-    log_info "Duration per experiment: ${DURATION} sec"
+    log_info "Duration per experiment: ${DURATION} sec (+${WARMUP} s warm-up, ${COOLDOWN} s cool-down)"
 
     # Run all experiments
     for impl_idx in $(seq 0 $(( ${#IMPLS[@]} - 1 ))); do
@@ -229,10 +293,20 @@ main() {
         done
     done
 
+    # Pacing comparison: the same offered rate paced by each side
+    echo "implementation,pacer,rate,msg_size,threads,throughput_gbps,cpu_ns_per_byte,cpu_core_pct,p99_us" > "${PACE_CSV}"
+    for impl_name in "${IMPLS[@]}"; do
+        for mode in "${PACE_MODES[@]}"; do
+            run_pacing_experiment ${impl_name} ${mode}
+            sleep 2
+        done
+    done
+
     log_info "=========================================="
     log_info "All experiments complete!"
     log_info "Results saved to: ${CSV_FILE}"
-    log_info "Perf logs saved to: ${PERF_DIR}/"
+    log_info "Pacing comparison saved to: ${PACE_CSV}"
+    log_info "Client logs saved to: ${PERF_DIR}/"
     log_info "=========================================="
 
     # Print summary table
@@ -0,0 +1,764 @@
+/*
+ * MT25062_Server.c
+ * Netbench TCP Server (Receiver Side)
+ * Roll No: MT25062
+ *
+ * One server for every client copy strategy (A1..A4): the copy
+ * reductions all happen on the sender, so the receive path is shared.
+ * The server accepts multiple concurrent clients and hands each one to
+ * a receive engine (-m):
+ *   thread   - one detached thread per client (default). Each thread
+ *              receives fixed-size messages using blocking recv().
+ *              (MT25062_Server_Thread.c)
+ *   epoll    - a fixed pool of worker threads, each running an
+ *              edge-triggered epoll loop over many non-blocking client
+ *              sockets. Thread count is bounded by cores, not clients.
+ *              (MT25062_Server_Epoll.c)
+ *   uring    - a fixed pool of io_uring workers. Each arms one multishot
+ *              recv per connection that selects buffers from a registered
+ *              provided-buffer ring, so completions for many connections
+ *              are harvested in batches with one io_uring_enter() call.
+ *              (MT25062_Server_Uring.c)
+ *   zerocopy - one thread per client using TCP_ZEROCOPY_RECEIVE: payload
+ *              pages are remapped into an mmap()ed window of the socket
+ *              instead of copied; only sub-page remainders use recv().
+ *              (MT25062_Server_Zerocopy.c)
+ *
+ * On the receive side, recv() performs one copy:
+ *   kernel socket buffer --> user-space buffer
+ *
+ * Echo mode: if the client sets config_t.echo, every msg_size message is
+ * sent back so the client can measure round-trip time. Echo sessions
+ * are served by a blocking thread (the epoll and uring engines hand
+ * them off).
+ *
+ * Sharded accept (-r N): N SO_REUSEPORT listeners share the port, each
+ * drained by its own accept thread pinned to one core; -c attaches a
+ * CBPF program that steers each SYN to the listener of the CPU that
+ * received it, keeping connection setup and receive work core-local.
+ *
+ * Placement: -P pins pool workers, shard accept threads and per-client
+ * threads with a compact/scatter/explicit CPU policy; -I instead places
+ * each connection on the core that handles its RX softirq, read back
+ * with SO_INCOMING_CPU. -N binds each recv_buf to the local node of
+ * its receiving thread, a remote node, or a given node.
+ *
+ * Live stats (-S ms): a stats thread reports every connection's bytes,
+ * receive calls and messages per interval as CSV (or -j JSON) lines on
+ * stdout or, with -U, as datagrams to a Unix socket.
+ *
+ * The a1..a3_server binaries are this server under the old names.
+ *
+ * Usage: ./netbench_server [-m thread|epoll|uring|zerocopy] [-w workers]
+ *                          [-r shards [-c]] [-P policy] [-I] [-N placement]
+ *                          [-S ms [-j] [-U path]] [port]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <signal.h>
+#include <sys/un.h>
+#include <linux/filter.h>
+
+#include "MT25062_Netbench.h"
+
+/* ========================= Receive Engines =========================== */
+static const recv_engine_t *const g_engines[] = {
+    &recv_thread,
+    &recv_epoll,
+    &recv_uring,
+    &recv_zerocopy,
+};
+#define NUM_ENGINES  (int)(sizeof(g_engines) / sizeof(g_engines[0]))
+
+/* find_engine - Looks up a receive engine by name, NULL if unknown */
+static const recv_engine_t *find_engine(const char *name) {
+    for (int i = 0; i < NUM_ENGINES; i++)
+        if (strcmp(g_engines[i]->name, name) == 0) return g_engines[i];
+    return NULL;
+}
+
+/* ========================= Global State ============================== */
+volatile int g_running      = 1;
+cpu_policy_t g_pin;                 /* PIN_NONE unless -P is given */
+int          g_pin_incoming = 0;
+
+/* ========================= Live Statistics =========================== */
+/*
+ * With -S, sessions in progress are linked on g_live so a stats thread
+ * can report each one's interval throughput. The lock is only taken at
+ * session start and end and once per interval, never per receive.
+ */
+static pthread_mutex_t g_live_lock = PTHREAD_MUTEX_INITIALIZER;
+static conn_state_t   *g_live;
+static int             g_stats_ms;      /* -S: report interval, 0 = off   */
+static int             g_stats_json;    /* -j: JSON lines instead of CSV  */
+static int             g_stats_fd = -1; /* -U: datagram socket, else stdout */
+static struct sockaddr_un g_stats_addr;
+
+/* counter_add - Adds n to a single-writer counter read by the stats thread */
+static inline void counter_add(long long *ctr, long long n) {
+    __atomic_store_n(ctr, *ctr + n, __ATOMIC_RELAXED);
+}
+
+/* live_add - Links a started session onto g_live (no-op without -S) */
+static void live_add(conn_state_t *c) {
+    if (g_stats_ms <= 0) return;
+    pthread_mutex_lock(&g_live_lock);
+    c->live_next = g_live;
+    if (g_live) g_live->live_prev = c;
+    g_live  = c;
+    c->live = 1;
+    pthread_mutex_unlock(&g_live_lock);
+}
+
+/* live_remove - Unlinks a session before it is freed */
+static void live_remove(conn_state_t *c) {
+    if (!c->live) return;
+    pthread_mutex_lock(&g_live_lock);
+    if (c->live_prev) c->live_prev->live_next = c->live_next;
+    else              g_live                  = c->live_next;
+    if (c->live_next) c->live_next->live_prev = c->live_prev;
+    c->live = 0;
+    pthread_mutex_unlock(&g_live_lock);
+}
+
+/* stats_emit - Writes one report line to stdout or the -U socket */
+static void stats_emit(const char *line) {
+    if (g_stats_fd < 0) {
+        fputs(line, stdout);
+        return;
+    }
+    /* Nobody listening is fine: the line is dropped */
+    sendto(g_stats_fd, line, strlen(line), MSG_DONTWAIT,
+           (struct sockaddr *)&g_stats_addr, sizeof(g_stats_addr));
+}
+
+/*
+ * stats_line - Formats one interval report: bytes, throughput, receive
+ * calls, mean bytes per receive and messages since the last report.
+ * conn is the session id, or -1 for the sum over all sessions.
+ */
+static void stats_line(double t, int conn, long long bytes, long long calls,
+                       long long msgs, double interval) {
+    char   line[256];
+    char   id[16];
+    double gbps = bytes * 8.0 / (interval * 1e9);
+    double per  = calls ? (double)bytes / calls : 0.0;
+
+    if (conn < 0) snprintf(id, sizeof(id), g_stats_json ? "\"all\"" : "all");
+    else          snprintf(id, sizeof(id), "%d", conn);
+    if (g_stats_json)
+        snprintf(line, sizeof(line),
+                 "{\"t\":%.3f,\"conn\":%s,\"bytes\":%lld,\"gbps\":%.4f,"
+                 "\"recvs\":%lld,\"bytes_per_recv\":%.1f,\"msgs\":%lld}\n",
+                 t, id, bytes, gbps, calls, per, msgs);
+    else
+        snprintf(line, sizeof(line), "STATS,%.3f,%s,%lld,%.4f,%lld,%.1f,%lld\n",
+                 t, id, bytes, gbps, calls, per, msgs);
+    stats_emit(line);
+}
+
+/*
+ * stats_loop - Every -S milliseconds, reports each live session's
+ * counters since the previous report and their sum; t is seconds since
+ * the server started. Sessions that end between reports are covered by
+ * their own closing lines instead.
+ */
+static void *stats_loop(void *arg) {
+    (void)arg;
+    uint64_t start    = clock_now_ns();
+    uint64_t interval = (uint64_t)g_stats_ms * 1000000ULL;
+    uint64_t last     = start;
+    uint64_t next     = start + interval;
+
+    while (g_running) {
+        uint64_t now = clock_now_ns();
+        if (now < next) {
+            struct timespec nap = { (time_t)((next - now) / 1000000000ULL),
+                                    (long)((next - now) % 1000000000ULL) };
+            nanosleep(&nap, NULL);
+            continue;
+        }
+        double    t     = (now - start) / 1e9;
+        double    span  = (now - last) / 1e9;
+        long long bytes = 0, calls = 0, msgs = 0;
+
+        pthread_mutex_lock(&g_live_lock);
+        for (conn_state_t *c = g_live; c; c = c->live_next) {
+            long long b = __atomic_load_n(&c->total_bytes, __ATOMIC_RELAXED);
+            long long r = __atomic_load_n(&c->recv_calls, __ATOMIC_RELAXED);
+            long long m = __atomic_load_n(&c->msgs, __ATOMIC_RELAXED);
+            stats_line(t, c->thread_id, b - c->stat_bytes, r - c->stat_calls,
+                       m - c->stat_msgs, span);
+            bytes += b - c->stat_bytes;
+            calls += r - c->stat_calls;
+            msgs  += m - c->stat_msgs;
+            c->stat_bytes = b;
+            c->stat_calls = r;
+            c->stat_msgs  = m;
+        }
+        pthread_mutex_unlock(&g_live_lock);
+        stats_line(t, -1, bytes, calls, msgs, span);
+        if (g_stats_fd < 0) fflush(stdout);
+
+        last  = now;
+        next += interval;
+        if (next <= now) next = now + interval;   /* fell behind: skip ticks */
+    }
+    return NULL;
+}
+
+/*
+ * stats_open_socket - Points -S output at the Unix datagram socket
+ * 'path', to be bound by the reader (e.g. socat UNIX-RECV:path -).
+ * Returns: 0 on success, -1 on error.
+ */
+static int stats_open_socket(const char *path) {
+    if (strlen(path) >= sizeof(g_stats_addr.sun_path)) {
+        fprintf(stderr, "[Server] -U path too long: %s\n", path);
+        return -1;
+    }
+    g_stats_fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (g_stats_fd < 0) {
+        perror("socket AF_UNIX");
+        return -1;
+    }
+    g_stats_addr.sun_family = AF_UNIX;
+    strcpy(g_stats_addr.sun_path, path);
+    return 0;
+}
+
+/* ========================= Connection State ========================== */
+/*
+ * conn_start - Validates the received config and allocates recv_buf.
+ * The buffer is placed per -N from the thread that will receive into it.
+ * The uring engine receives into provided buffers and only needs a
+ * placeholder recv_buf to mark the session as started.
+ * Returns: 0 on success, -1 if the connection should be dropped.
+ */
+int conn_start(conn_state_t *c, int need_buf) {
+    int msg_size = c->config.msg_size;
+    if (msg_size <= 0) {
+        fprintf(stderr, "[Server T%d] Invalid msg_size=%d\n", c->thread_id, msg_size);
+        return -1;
+    }
+    printf("[Server T%d] Client connected: msg_size=%d, duration=%d%s%s%s\n",
+           c->thread_id, msg_size, c->config.duration,
+           c->config.echo ? ", echo" : "", c->config.framed ? ", framed" : "",
+           c->config.checksum ? ", checksummed" : "");
+
+    if (c->config.framed && !(c->owd = calloc(1, sizeof(*c->owd)))) {
+        perror("calloc owd histogram");
+        return -1;
+    }
+    c->recv_len = need_buf ? (size_t)msg_size : 1;
+    c->recv_buf = (char *)numa_alloc(c->recv_len);
+    if (!c->recv_buf) {
+        perror("alloc recv_buf");
+        return -1;
+    }
+    c->start_ns = clock_now_ns();
+    live_add(c);
+    return 0;
+}
+
+/*
+ * conn_recv_config - Blocking receive of the config_t handshake.
+ * Returns: 0 on success, -1 if the client went away first.
+ */
+int conn_recv_config(conn_state_t *c) {
+    ssize_t cfg_bytes = recv(c->client_fd, &c->config, sizeof(c->config), MSG_WAITALL);
+    if (cfg_bytes != sizeof(c->config)) {
+        fprintf(stderr, "[Server T%d] Failed to receive config\n", c->thread_id);
+        return -1;
+    }
+    c->cfg_received = sizeof(c->config);
+    return 0;
+}
+
+/*
+ * conn_check_seq - Compares a completed header's seq with the one
+ * expected next. A jump forward counts the skipped numbers as missing;
+ * a number below the expected one is out of order and, if it fills an
+ * earlier gap, is no longer missing. TCP delivers in order, so nonzero
+ * counts point at a sender or reassembly bug.
+ */
+static void conn_check_seq(conn_state_t *c) {
+    int32_t gap = (int32_t)(c->hdr.seq - c->next_seq);
+    if (gap < 0) {
+        c->seq_reordered++;
+        if (c->seq_missing > 0) c->seq_missing--;
+        return;
+    }
+    c->seq_missing += gap;
+    c->next_seq     = c->hdr.seq + 1;
+}
+
+/*
+ * conn_message_done - Accounts one complete framed message received at
+ * now_ns: checksum verdict, one-way latency from the sender's timestamp
+ * (clamped at zero should the clocks disagree) and the session's
+ * last-message time.
+ */
+static void conn_message_done(conn_state_t *c, uint64_t now_ns) {
+    uint64_t owd = now_ns > c->hdr.ts_ns ? now_ns - c->hdr.ts_ns : 0;
+    if (c->config.checksum && c->crc != c->hdr.crc) c->crc_bad++;
+    counter_add(&c->msgs, 1);
+    c->owd_total_ns += owd;
+    hist_record(c->owd, owd);
+    c->last_ns = now_ns;
+}
+
+/* conn_checksum - Extends the current message's CRC, timing the work */
+static void conn_checksum(conn_state_t *c, const char *data, size_t len) {
+    uint64_t start = clock_now_ns();
+    c->crc     = crc32c_update(c->crc, data, len);
+    c->crc_ns += clock_now_ns() - start;
+}
+
+/*
+ * conn_account - Counts received bytes and, for framed sessions, walks
+ * the frame headers in them to count whole messages. Payload bytes are
+ * skipped arithmetically, so only headers are read, unless the session
+ * carries checksums and the payload must be CRCed. Headers may be
+ * split across calls; the partial header is kept in the conn_state.
+ * Every message completed by one call arrived in the same receive, so
+ * the clock is read once per call, and only if a message completes.
+ */
+void conn_account(conn_state_t *c, const char *data, size_t len) {
+    uint64_t now_ns = 0;
+    counter_add(&c->total_bytes, (long long)len);
+    counter_add(&c->recv_calls, 1);
+    if (!c->config.framed) return;
+
+    while (len > 0) {
+        if (c->payload_left > 0) {
+            size_t take = len < c->payload_left ? len : c->payload_left;
+            if (c->config.checksum) conn_checksum(c, data, take);
+            c->payload_left -= take;
+            data            += take;
+            len             -= take;
+            if (c->payload_left > 0) break;
+        } else {
+            size_t need = sizeof(c->hdr) - c->hdr_have;
+            size_t take = len < need ? len : need;
+            memcpy((char *)&c->hdr + c->hdr_have, data, take);
+            c->hdr_have += take;
+            data        += take;
+            len         -= take;
+            if (c->hdr_have < sizeof(c->hdr)) break;
+
+            c->hdr_have = 0;
+            c->crc      = 0;
+            conn_check_seq(c);
+            if (c->hdr.len > (uint32_t)c->config.msg_size) c->bad_frames++;
+            c->payload_left = c->hdr.len;
+            if (c->payload_left > 0) continue;
+        }
+        if (!now_ns) now_ns = clock_now_ns();
+        conn_message_done(c, now_ns);
+    }
+}
+
+/*
+ * conn_echo_loop - Ping-pong service on a blocking socket: every byte
+ * received is sent straight back until the client closes. Echoing the
+ * stream rather than msg_size chunks works for framed, variable-size
+ * messages too; the client waits for exactly what it sent.
+ * TCP_NODELAY keeps Nagle from holding back the last segment of a reply.
+ */
+void conn_echo_loop(conn_state_t *c) {
+    int one = 1;
+    setsockopt(c->client_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    while (g_running) {
+        ssize_t bytes = recv(c->client_fd, c->recv_buf, c->recv_len, 0);
+        if (bytes <= 0) break;
+        conn_account(c, c->recv_buf, (size_t)bytes);
+        if (send_all(c->client_fd, c->recv_buf, bytes, 0) < 0) break;
+    }
+}
+
+/*
+ * conn_report_framed - Prints a framed session's message accounting and
+ * a RESULT line in the client's format, with the one-way latency in
+ * place of the send latency. The session runs from the handshake to the
+ * last complete message, so trailing idle time does not dilute rates.
+ */
+static void conn_report_framed(conn_state_t *c) {
+    double elapsed = c->last_ns > c->start_ns ? (c->last_ns - c->start_ns) / 1e9 : 0.0;
+    double avg_us  = c->msgs ? c->owd_total_ns / 1e3 / c->msgs : 0.0;
+
+    printf("[Server T%d] Framed: %lld messages (%.0f msgs/sec), mean %.0f bytes, "
+           "%lld oversized, %s\n",
+           c->thread_id, c->msgs, elapsed > 0 ? c->msgs / elapsed : 0.0,
+           c->msgs ? (double)c->total_bytes / c->msgs : 0.0, c->bad_frames,
+           (c->hdr_have || c->payload_left) ? "truncated last message"
+                                            : "clean boundary");
+    printf("[Server T%d] Sequence: %lld missing, %lld out of order\n",
+           c->thread_id, c->seq_missing, c->seq_reordered);
+    if (c->config.checksum)
+        printf("[Server T%d] Checksum: %lld of %lld messages mismatched, "
+               "CRC32C (%s) at %.2f GB/s, %.2f%% of session\n",
+               c->thread_id, c->crc_bad, c->msgs, crc32c_impl(),
+               c->crc_ns ? (c->total_bytes - c->msgs * (long long)sizeof(frame_hdr_t)) /
+                           (double)c->crc_ns : 0.0,
+               elapsed > 0 ? 100.0 * c->crc_ns / 1e9 / elapsed : 0.0);
+    printf("[Server T%d] One-way latency: avg %.2f us, p50 %.2f, p99 %.2f, max %.2f us\n",
+           c->thread_id, avg_us, hist_percentile_us(c->owd, 50.0),
+           hist_percentile_us(c->owd, 99.0), c->owd->max_ns / 1e3);
+    if (elapsed > 0)
+        print_results("server", c->config.msg_size, 1, c->total_bytes, elapsed,
+                      avg_us, c->owd, NULL);
+}
+
+/*
+ * conn_finish - Reports bytes (and, if framed, messages) received if the
+ * session started, then closes.
+ */
+void conn_finish(conn_state_t *c) {
+    if (c->recv_buf) {
+        printf("[Server T%d] Received %lld bytes (%.2f MB)\n",
+               c->thread_id, c->total_bytes, c->total_bytes / (1024.0 * 1024.0));
+        if (c->config.framed) conn_report_framed(c);
+    }
+    live_remove(c);
+    free(c->owd);
+    free(c->echo_backlog);
+    numa_free(c->recv_buf, c->recv_len);
+    close(c->client_fd);
+    free(c);
+}
+
+/*
+ * conn_spawn - Runs fn(c) on a detached thread.
+ * Returns: 0 on success, -1 (connection still owned by the caller).
+ */
+int conn_spawn(conn_state_t *c, void *(*fn)(void *)) {
+    pthread_t tid;
+    if (pthread_create(&tid, NULL, fn, c) != 0) {
+        perror("pthread_create");
+        return -1;
+    }
+    pthread_detach(tid);
+    return 0;
+}
+
+/* ========================= CPU Placement ============================= */
+
+/* incoming_cpu - CPU that processed the socket's last RX packet, or -1 */
+static int incoming_cpu(int fd) {
+    int       cpu = -1;
+    socklen_t len = sizeof(cpu);
+    if (getsockopt(fd, SOL_SOCKET, SO_INCOMING_CPU, &cpu, &len) < 0) return -1;
+    return cpu;
+}
+
+/*
+ * conn_pin - Places a per-client handler thread. With -I the thread
+ * follows SO_INCOMING_CPU, the core running the socket's RX softirq,
+ * so protocol processing and the copy to user space share its caches;
+ * otherwise -P picks a CPU by client id. Without either the thread
+ * keeps the affinity it inherited from its accept thread.
+ */
+void conn_pin(conn_state_t *c) {
+    int cpu = g_pin_incoming ? incoming_cpu(c->client_fd) : -1;
+    if (cpu < 0) cpu = cpu_policy_cpu(&g_pin, c->thread_id);
+    pin_thread_to_cpu(cpu);
+}
+
+/* worker_for_cpu - Index of the pool worker pinned to 'cpu', or -1 */
+static int worker_for_cpu(int cpu, int nworkers) {
+    if (cpu < 0) return -1;
+    for (int w = 0; w < nworkers; w++)
+        if (cpu_policy_cpu(&g_pin, w) == cpu) return w;
+    return -1;
+}
+
+/* ========================= Listener Shards =========================== */
+/*
+ * One accept thread per listening socket. Without -r there is a single
+ * unpinned listener; with -r N there are N SO_REUSEPORT
+ * listeners on the same port, each with its own accept thread pinned to
+ * CPU (shard % online CPUs, or the shard's -P slot). Thread-per-client handlers inherit that
+ * affinity from the accept thread, and pool engines receive a shard's
+ * connections on the workers congruent to the shard index, so a
+ * connection is set up and serviced on the same core group.
+ */
+typedef struct {
+    int                  shard;
+    int                  listen_fd;
+    int                  cpu;         /* -1 = not pinned */
+    int                  nshards;
+    const recv_engine_t *engine;
+    void                *pool;
+    int                  nworkers;
+    pthread_t            tid;
+} listener_t;
+
+static int g_next_client_id = 0;  /* shared by all accept threads */
+
+/* accept_loop - Accepts clients on one listener and hands them to the engine */
+static void *accept_loop(void *arg) {
+    listener_t *l           = (listener_t *)arg;
+    int         next_worker = l->pool ? l->shard % l->nworkers : 0;
+
+    pin_thread_to_cpu(l->cpu);
+
+    while (g_running) {
+        struct sockaddr_in client_addr;
+        socklen_t addr_len = sizeof(client_addr);
+
+        int client_fd = accept(l->listen_fd,
+                               (struct sockaddr *)&client_addr,
+                               &addr_len);
+        if (client_fd < 0) {
+            if (!g_running) break;
+            if (errno == EINTR) continue;
+            perror("accept");
+            continue;
+        }
+
+        int  thread_id = __atomic_fetch_add(&g_next_client_id, 1, __ATOMIC_RELAXED);
+        char client_ip[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &client_addr.sin_addr, client_ip, sizeof(client_ip));
+        if (l->nshards > 1)
+            printf("[Server] Shard %d accepted client %d from %s:%d\n",
+                   l->shard, thread_id, client_ip, ntohs(client_addr.sin_port));
+        else
+            printf("[Server] Accepted client %d from %s:%d\n",
+                   thread_id, client_ip, ntohs(client_addr.sin_port));
+
+        conn_state_t *c = calloc(1, sizeof(conn_state_t));
+        if (!c) {
+            perror("malloc conn state");
+            close(client_fd);
+            continue;
+        }
+        c->client_fd = client_fd;
+        c->thread_id = thread_id;
+
+        /* -I: prefer the worker pinned to the connection's RX core */
+        int worker = next_worker;
+        if (l->pool && g_pin_incoming) {
+            int w = worker_for_cpu(incoming_cpu(client_fd), l->nworkers);
+            if (w >= 0) worker = w;
+        }
+
+        if (l->engine->add_client(l->pool, worker, c) < 0) {
+            close(client_fd);
+            free(c);
+        }
+        if (l->pool && worker == next_worker)
+            next_worker = (next_worker + l->nshards) % l->nworkers;
+    }
+    return NULL;
+}
+
+/*
+ * attach_cpu_steering - Installs a classic BPF reuseport program that
+ * maps the core processing the incoming SYN to the shard whose accept
+ * thread is pinned there, so the connection is accepted on that core.
+ * The map follows the listeners' CPUs (the -P order, which need not be
+ * 0..N-1) as a chain of compares; a CPU outside it falls back to
+ * CPU % nshards. The program is shared by the whole reuseport group,
+ * so attaching it to one listener is enough.
+ * Returns: 0 on success, -1 (kernel keeps its default hash).
+ */
+static int attach_cpu_steering(const listener_t *listeners, int nshards) {
+    int                 len  = 2 * nshards + 3;
+    struct sock_filter *code = calloc(len, sizeof(*code));
+    if (!code) { perror("calloc steering"); return -1; }
+
+    int k = 0;
+    code[k++] = (struct sock_filter){ BPF_LD | BPF_W | BPF_ABS, 0, 0,
+                                      (uint32_t)(SKF_AD_OFF + SKF_AD_CPU) };
+    for (int i = 0; i < nshards; i++) {
+        /* A == cpu ? return shard : try the next CPU */
+        code[k++] = (struct sock_filter){ BPF_JMP | BPF_JEQ | BPF_K, 0, 1,
+                                          (uint32_t)listeners[i].cpu };
+        code[k++] = (struct sock_filter){ BPF_RET | BPF_K, 0, 0, (uint32_t)i };
+    }
+    code[k++] = (struct sock_filter){ BPF_ALU | BPF_MOD | BPF_K, 0, 0, (uint32_t)nshards };
+    code[k++] = (struct sock_filter){ BPF_RET | BPF_A, 0, 0, 0 };
+
+    struct sock_fprog prog = {
+        .len    = (unsigned short)len,
+        .filter = code,
+    };
+    int ret = setsockopt(listeners[0].listen_fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF,
+                         &prog, sizeof(prog));
+    if (ret < 0) perror("setsockopt SO_ATTACH_REUSEPORT_CBPF");
+    free(code);
+    return ret < 0 ? -1 : 0;
+}
+
+/* ========================= Usage ===================================== */
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [-m thread|epoll|uring|zerocopy] [-w workers] [-r shards [-c]]\n"
+            "          [-P compact|scatter|cpu-list] [-I] [-N local|remote|node]\n"
+            "          [-S ms [-j] [-U path]] [port]\n"
+            "  -m  receive engine (default: thread)\n"
+            "  -w  epoll/uring worker threads (default: online CPUs)\n"
+            "  -r  SO_REUSEPORT listeners, one pinned accept thread each\n"
+            "  -c  steer connections to the listener of the receiving CPU (CBPF)\n"
+            "  -P  pin workers, accept and client threads (e.g. compact, 0,2,4-7)\n"
+            "  -I  run each connection on its SO_INCOMING_CPU (RX softirq) core\n"
+            "  -N  place recv buffers: local, remote or a node id (mbind)\n"
+            "  -S  report live per-connection stats every ms milliseconds\n"
+            "  -j  -S lines as JSON instead of CSV\n"
+            "  -U  send -S lines as datagrams to the Unix socket at path\n",
+            prog);
+}
+
+/* ========================= Main ====================================== */
+int main(int argc, char *argv[]) {
+    const recv_engine_t *engine   = &recv_thread;
+    int                  ncpus    = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int                  nworkers = ncpus;
+    int                  nshards  = 0;
+    int                  steer    = 0;
+    int                  opt;
+
+    while ((opt = getopt(argc, argv, "m:w:r:cP:IN:S:jU:h")) != -1) {
+        switch (opt) {
+        case 'm': engine   = find_engine(optarg); break;
+        case 'w': nworkers = atoi(optarg);        break;
+        case 'r': nshards  = atoi(optarg);        break;
+        case 'c': steer    = 1;                   break;
+        case 'I': g_pin_incoming = 1;             break;
+        case 'S': g_stats_ms = atoi(optarg);      break;
+        case 'j': g_stats_json = 1;               break;
+        case 'U':
+            if (stats_open_socket(optarg) < 0) return EXIT_FAILURE;
+            break;
+        case 'P':
+            if (cpu_policy_parse(&g_pin, optarg) < 0) {
+                fprintf(stderr, "[Server] Bad -P policy: %s\n", optarg);
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'N':
+            if (numa_policy_parse(&g_numa, optarg) < 0) {
+                fprintf(stderr, "[Server] Bad -N placement: %s\n", optarg);
+                return EXIT_FAILURE;
+            }
+            break;
+        default:  usage(argv[0]);                 return EXIT_FAILURE;
+        }
+    }
+    if (!engine || nshards < 0 || (steer && nshards == 0) || g_stats_ms < 0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (nworkers <= 0) nworkers = 1;
+    if (ncpus <= 0)    ncpus    = 1;
+
+    /* -c: exactly one shard per core, or some cores have no listener */
+    int steer_cpus = g_pin.mode != PIN_NONE ? g_pin.ncpus : ncpus;
+    if (steer && nshards != steer_cpus) {
+        fprintf(stderr, "[Server] -c needs one shard per %s CPU: use -r %d\n",
+                g_pin.mode != PIN_NONE ? "pinned" : "online", steer_cpus);
+        return EXIT_FAILURE;
+    }
+
+    /* -I on a pool engine needs workers pinned to known cores */
+    if (g_pin_incoming && engine->start && g_pin.mode == PIN_NONE)
+        cpu_policy_parse(&g_pin, "compact");
+    cpu_policy_describe(&g_pin, "Server");
+    numa_policy_describe(&g_numa, "Server");
+
+    int port = (optind < argc) ? atoi(argv[optind]) : SERVER_PORT;
+
+    /*
+     * SIGINT/SIGTERM stay blocked in every thread (the mask is inherited)
+     * and main collects them with sigwait(), so Ctrl-C cannot land on an
+     * accept or client thread whose blocking call would just restart.
+     */
+    sigset_t stop_sigs;
+    sigemptyset(&stop_sigs);
+    sigaddset(&stop_sigs, SIGINT);
+    sigaddset(&stop_sigs, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stop_sigs, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    int         nlisteners = nshards > 0 ? nshards : 1;
+    listener_t *listeners  = calloc(nlisteners, sizeof(listener_t));
+    if (!listeners) {
+        perror("calloc listeners");
+        return EXIT_FAILURE;
+    }
+    for (int i = 0; i < nlisteners; i++)
+        listeners[i].listen_fd = create_server_socket(port, nshards > 0);
+
+    pthread_t stats_tid;
+    if (g_stats_ms > 0) {
+        if (pthread_create(&stats_tid, NULL, stats_loop, NULL) != 0) {
+            perror("pthread_create stats");
+            g_stats_ms = 0;
+        } else {
+            pthread_detach(stats_tid);
+            printf("[Server] Live stats every %d ms (%s%s%s)\n", g_stats_ms,
+                   g_stats_json ? "JSON" : "CSV",
+                   g_stats_fd >= 0 ? " to " : "", g_stats_fd >= 0 ? g_stats_addr.sun_path : "");
+        }
+    }
+
+    void *pool = NULL;
+    if (engine->start && !(pool = engine->start(nworkers))) {
+        fprintf(stderr, "[Server] %s unavailable, falling back to thread engine\n",
+                engine->name);
+        engine = &recv_thread;
+    }
+
+    for (int i = 0; i < nlisteners; i++) {
+        listeners[i].shard    = i;
+        listeners[i].cpu      = nshards == 0 ? -1 :
+                                g_pin.mode != PIN_NONE ? cpu_policy_cpu(&g_pin, i) :
+                                i % ncpus;
+        listeners[i].nshards  = nlisteners;
+        listeners[i].engine   = engine;
+        listeners[i].pool     = pool;
+        listeners[i].nworkers = nworkers;
+    }
+    if (steer && attach_cpu_steering(listeners, nshards) == 0)
+        printf("[Server] CPU steering across %d listeners\n", nshards);
+
+    /* --- Accept thread(s): hand each client to the receive engine --- */
+    int started = 0;
+    for (; started < nlisteners; started++) {
+        if (pthread_create(&listeners[started].tid, NULL, accept_loop,
+                           &listeners[started]) != 0) {
+            perror("pthread_create accept");
+            break;
+        }
+    }
+    if (started == nlisteners) {
+        int sig;
+        sigwait(&stop_sigs, &sig);
+    }
+    g_running = 0;
+
+    /* shutdown() on a listening socket wakes a blocked accept() */
+    for (int i = 0; i < nlisteners; i++)
+        shutdown(listeners[i].listen_fd, SHUT_RDWR);
+    for (int i = 0; i < started; i++)
+        pthread_join(listeners[i].tid, NULL);
+
+    printf("[Server] Shutting down.\n");
+    if (engine->stop) engine->stop(pool, nworkers);
+    for (int i = 0; i < nlisteners; i++)
+        close(listeners[i].listen_fd);
+    free(listeners);
+    return 0;
+}
@@ -0,0 +1,235 @@
+/*
+ * MT25062_Server_Epoll.c
+ * Edge-Triggered epoll Receive Engine (Receiver Side)
+ * Roll No: MT25062
+ *
+ * Receive engine -m epoll: a fixed pool of worker threads, each running
+ * an edge-triggered epoll loop over many non-blocking client sockets.
+ * Thread count is bounded by cores, not clients.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <errno.h>
+
+#include "MT25062_Netbench.h"
+
+/* ========================= Constants ================================= */
+#define EPOLL_MAX_EVENTS   256   /* Events harvested per epoll_wait()       */
+#define EPOLL_WAIT_MS      500   /* Wake-up period to observe g_running     */
+#define EPOLL_RECV_BUDGET  64    /* recv() calls per connection per pass    */
+
+/* ========================= Epoll Engine ============================== */
+/*
+ * Each worker owns one epoll instance. The accept loop hands new
+ * sockets to workers round-robin; from then on only the owning worker
+ * touches the connection, so no locking is needed.
+ */
+typedef struct {
+    int          worker_id;
+    int          epoll_fd;
+    volatile int stop;          /* set to retire a worker before g_running */
+    pthread_t    tid;
+} epoll_worker_t;
+
+/* Result of one non-blocking receive pass over a connection */
+enum { CONN_IDLE, CONN_BUSY, CONN_CLOSED, CONN_ECHO };
+
+/*
+ * conn_drain - Runs one non-blocking receive pass over a connection.
+ *
+ * With edge-triggered epoll the socket must be read until EAGAIN, but
+ * a fast sender could keep one connection busy forever. The pass is
+ * therefore capped at EPOLL_RECV_BUDGET recv() calls; a connection that
+ * exhausts its budget is requeued behind the others.
+ */
+static int conn_drain(conn_state_t *c) {
+    /* The config_t handshake may arrive in pieces on a non-blocking socket */
+    while (c->cfg_received < sizeof(c->config)) {
+        ssize_t n = recv(c->client_fd, (char *)&c->config + c->cfg_received,
+                         sizeof(c->config) - c->cfg_received, 0);
+        if (n > 0) { c->cfg_received += n; continue; }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return CONN_IDLE;
+        fprintf(stderr, "[Server T%d] Failed to receive config\n", c->thread_id);
+        return CONN_CLOSED;
+    }
+    if (!c->recv_buf) {
+        if (conn_start(c, 1) < 0) return CONN_CLOSED;
+        if (c->config.echo) return CONN_ECHO;
+    }
+
+    for (int i = 0; i < EPOLL_RECV_BUDGET; i++) {
+        ssize_t bytes = recv(c->client_fd, c->recv_buf, c->config.msg_size, 0);
+        if (bytes > 0) { conn_account(c, c->recv_buf, (size_t)bytes); continue; }
+        if (bytes < 0 && errno == EINTR) continue;
+        if (bytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return CONN_IDLE;
+        return CONN_CLOSED;
+    }
+    return CONN_BUSY;
+}
+
+/* echo_thread - Serves an echo session handed off by an epoll worker */
+static void *echo_thread(void *arg) {
+    conn_state_t *c = (conn_state_t *)arg;
+    conn_pin(c);
+    conn_echo_loop(c);
+    conn_finish(c);
+    return NULL;
+}
+
+/*
+ * epoll_handoff_echo - Moves an echo session off the event loop.
+ * Only the config_t has been read, so no payload is lost; the socket is
+ * made blocking again and served by its own thread.
+ */
+static void epoll_handoff_echo(epoll_worker_t *w, conn_state_t *c) {
+    epoll_ctl(w->epoll_fd, EPOLL_CTL_DEL, c->client_fd, NULL);
+    int flags = fcntl(c->client_fd, F_GETFL, 0);
+    if (flags >= 0) fcntl(c->client_fd, F_SETFL, flags & ~O_NONBLOCK);
+
+    if (conn_spawn(c, echo_thread) < 0) conn_finish(c);
+}
+
+/*
+ * epoll_worker - Event loop for one worker thread.
+ * Ready connections are collected on an intrusive list and serviced
+ * round-robin; while the list is non-empty epoll_wait() does not block.
+ */
+static void *epoll_worker(void *arg) {
+    epoll_worker_t    *w = (epoll_worker_t *)arg;
+    struct epoll_event events[EPOLL_MAX_EVENTS];
+    conn_state_t      *ready = NULL;
+    conn_state_t      *tail  = NULL;
+
+    pin_thread_to_cpu(cpu_policy_cpu(&g_pin, w->worker_id));
+
+    while (g_running && !w->stop) {
+        int n = epoll_wait(w->epoll_fd, events, EPOLL_MAX_EVENTS,
+                           ready ? 0 : EPOLL_WAIT_MS);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait");
+            break;
+        }
+
+        for (int i = 0; i < n; i++) {
+            conn_state_t *c = (conn_state_t *)events[i].data.ptr;
+            if (c->queued) continue;
+            c->queued     = 1;
+            c->next_ready = NULL;
+            if (tail) tail->next_ready = c; else ready = c;
+            tail = c;
+        }
+
+        /* Service each currently-ready connection once */
+        conn_state_t *list = ready;
+        ready = tail = NULL;
+        while (list) {
+            conn_state_t *c = list;
+            list      = c->next_ready;
+            c->queued = 0;
+
+            int state = conn_drain(c);
+            if (state == CONN_BUSY) {
+                c->queued     = 1;
+                c->next_ready = NULL;
+                if (tail) tail->next_ready = c; else ready = c;
+                tail = c;
+            } else if (state == CONN_CLOSED) {
+                epoll_ctl(w->epoll_fd, EPOLL_CTL_DEL, c->client_fd, NULL);
+                conn_finish(c);
+            } else if (state == CONN_ECHO) {
+                epoll_handoff_echo(w, c);
+            }
+        }
+    }
+    return NULL;
+}
+
+/*
+ * release_epoll_workers - Unwinds a partial start: stops and joins the
+ * first 'started' workers (they hold no connections yet), then closes
+ * every epoll instance created so far.
+ */
+static void release_epoll_workers(epoll_worker_t *workers, int count, int started) {
+    for (int i = 0; i < started; i++) workers[i].stop = 1;
+    for (int i = 0; i < started; i++) pthread_join(workers[i].tid, NULL);
+    for (int i = 0; i < count; i++)
+        if (workers[i].epoll_fd >= 0) close(workers[i].epoll_fd);
+    free(workers);
+}
+
+/*
+ * start_epoll_workers - Creates 'count' epoll instances and worker threads.
+ * Returns: Array of epoll_worker_t, or NULL if any of them could not be
+ * set up (everything created so far is released).
+ */
+static void *start_epoll_workers(int count) {
+    epoll_worker_t *workers = calloc(count, sizeof(epoll_worker_t));
+    if (!workers) { perror("calloc workers"); return NULL; }
+
+    for (int i = 0; i < count; i++) workers[i].epoll_fd = -1;
+    for (int i = 0; i < count; i++) {
+        workers[i].worker_id = i;
+        workers[i].epoll_fd  = epoll_create1(EPOLL_CLOEXEC);
+        if (workers[i].epoll_fd < 0) {
+            perror("epoll_create1");
+            release_epoll_workers(workers, count, 0);
+            return NULL;
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        if (pthread_create(&workers[i].tid, NULL, epoll_worker, &workers[i]) != 0) {
+            perror("pthread_create");
+            release_epoll_workers(workers, count, i);
+            return NULL;
+        }
+    }
+    printf("[Server] Epoll engine: %d worker threads\n", count);
+    return workers;
+}
+
+/*
+ * epoll_add_client - Hands an accepted socket to a worker.
+ * The socket is made non-blocking and registered edge-triggered; data
+ * already queued (e.g. the config_t) raises an initial event on add.
+ */
+static int epoll_add_client(void *pool, int worker, conn_state_t *c) {
+    epoll_worker_t *w = &((epoll_worker_t *)pool)[worker];
+    int flags = fcntl(c->client_fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(c->client_fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        perror("fcntl O_NONBLOCK");
+        return -1;
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events   = EPOLLIN | EPOLLRDHUP | EPOLLET;
+    ev.data.ptr = c;
+    if (epoll_ctl(w->epoll_fd, EPOLL_CTL_ADD, c->client_fd, &ev) < 0) {
+        perror("epoll_ctl ADD");
+        return -1;
+    }
+    return 0;
+}
+
+/* stop_epoll_workers - Joins the workers once g_running is cleared */
+static void stop_epoll_workers(void *pool, int count) {
+    epoll_worker_t *workers = (epoll_worker_t *)pool;
+    for (int i = 0; i < count; i++) pthread_join(workers[i].tid, NULL);
+    free(workers);
+}
+
+const recv_engine_t recv_epoll = {
+    .name       = "epoll",
+    .start      = start_epoll_workers,
+    .add_client = epoll_add_client,
+    .stop       = stop_epoll_workers,
+};
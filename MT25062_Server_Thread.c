@@ -0,0 +1,85 @@
+/*
+ * MT25062_Server_Thread.c
+ * Thread-per-Client Receive Engine (Receiver Side)
+ * Roll No: MT25062
+ *
+ * Default receive engine (-m thread): one detached thread per client,
+ * receiving fixed-size messages with blocking recv().
+ *
+ * On the receive side, recv() performs one copy:
+ *   kernel socket buffer --> user-space buffer
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+
+#include "MT25062_Netbench.h"
+
+/* ========================= Thread Engine ============================= */
+/*
+ * handle_client - Thread function to handle one client connection.
+ *
+ * Protocol:
+ *   1. Receive config_t from client (msg_size, duration), then pin
+ *      the thread per -P / -I.
+ *   2. Allocate receive buffer of msg_size bytes on heap.
+ *   3. Receive data in a loop until client closes connection
+ *      (or echo each message back if the client asked for echo).
+ *   4. Report total bytes (and framed messages) received.
+ *
+ * The recv() call performs one copy: kernel buffer --> user buffer.
+ */
+static void *handle_client(void *arg) {
+    conn_state_t *c = (conn_state_t *)arg;
+
+    /* --- Step 1: Receive configuration from client --- */
+    if (conn_recv_config(c) < 0) {
+        conn_finish(c);
+        return NULL;
+    }
+    conn_pin(c);
+
+    /* --- Step 2: Allocate receive buffer (heap) --- */
+    if (conn_start(c, 1) < 0) {
+        conn_finish(c);
+        return NULL;
+    }
+
+    /* --- Step 3: Receive loop --- */
+    if (c->config.echo) {
+        conn_echo_loop(c);
+        conn_finish(c);
+        return NULL;
+    }
+
+    while (g_running) {
+        /*
+         * recv() copies data from kernel socket buffer to user buffer.
+         * This is the receive-side copy (1 of the 2 copies in two-copy).
+         */
+        ssize_t bytes = recv(c->client_fd, c->recv_buf, c->config.msg_size, 0);
+        if (bytes <= 0) {
+            break;
+        }
+        conn_account(c, c->recv_buf, (size_t)bytes);
+    }
+
+    /* --- Step 4: Report and cleanup --- */
+    conn_finish(c);
+    return NULL;
+}
+
+/* thread_add_client - Serves the connection on its own detached thread */
+static int thread_add_client(void *pool, int worker, conn_state_t *c) {
+    (void)pool;
+    (void)worker;
+    return conn_spawn(c, handle_client);
+}
+
+const recv_engine_t recv_thread = {
+    .name       = "thread",
+    .start      = NULL,
+    .add_client = thread_add_client,
+    .stop       = NULL,
+};
@@ -0,0 +1,412 @@
+/*
+ * MT25062_Server_Uring.c
+ * io_uring Multishot Receive Engine (Receiver Side)
+ * Roll No: MT25062
+ *
+ * Receive engine -m uring: a fixed pool of io_uring workers. Each arms
+ * one multishot recv per connection that selects buffers from a
+ * registered provided-buffer ring, so completions for many connections
+ * are harvested in batches with one io_uring_enter() call. Uses the
+ * ring wrapper from MT25062_Netbench.c.
+ *
+ * Echo sessions are handed to a blocking thread, as in the epoll engine.
+ * The multishot recv may already have pulled payload into provided
+ * buffers by then, so the worker cancels it, keeps every byte that
+ * arrives until it ends, and the echo thread sends that backlog back
+ * before serving the socket itself.
+ *
+ * Requirements: Linux kernel >= 6.0 (multishot recv, PBUF_RING). The
+ * server falls back to the thread engine if setup fails.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <errno.h>
+
+#include "MT25062_Netbench.h"
+
+/* ========================= Constants ================================= */
+#define URING_ENTRIES      256   /* SQ depth per worker ring                */
+#define URING_BUF_COUNT    512   /* Provided buffers per worker (power of 2)*/
+#define URING_BUF_SIZE     16384 /* Bytes per provided buffer               */
+#define URING_BGID         0     /* Provided-buffer group id                */
+#define URING_WAIT_MS      500   /* Wake-up period to observe g_running     */
+#define URING_WAKE_TAG     0     /* user_data of the handoff eventfd read   */
+#define URING_CANCEL_TAG   1     /* user_data of echo-handoff cancels       */
+
+/* ========================= io_uring Engine =========================== */
+/*
+ * Each worker owns one ring and one provided-buffer ring. The accept
+ * loop pushes new connections onto 'pending' and kicks wake_fd; the
+ * worker keeps a read armed on wake_fd and arms the new sockets itself,
+ * so only the owning thread ever submits to its ring.
+ */
+typedef struct {
+    int                       worker_id;
+    uring_t                   ring;
+    struct io_uring_buf_ring *buf_ring;
+    char                     *buf_base;
+    unsigned short            buf_tail;
+    int                       wake_fd;
+    uint64_t                  wake_val;
+    pthread_mutex_t           lock;
+    conn_state_t             *pending;
+    volatile int              stop;     /* retire before g_running clears */
+    pthread_t                 tid;
+} uring_worker_t;
+
+/* uring_buf_recycle - Returns buffer 'bid' to the ring (published later) */
+static void uring_buf_recycle(uring_worker_t *w, unsigned bid) {
+    struct io_uring_buf *b = &w->buf_ring->bufs[w->buf_tail & (URING_BUF_COUNT - 1)];
+    b->addr = (uint64_t)(uintptr_t)(w->buf_base + (size_t)bid * URING_BUF_SIZE);
+    b->len  = URING_BUF_SIZE;
+    b->bid  = (unsigned short)bid;
+    w->buf_tail++;
+}
+
+/* uring_buf_publish - Makes all recycled buffers visible to the kernel */
+static void uring_buf_publish(uring_worker_t *w) {
+    __atomic_store_n(&w->buf_ring->tail, w->buf_tail, __ATOMIC_RELEASE);
+}
+
+/* uring_setup_buffers - Allocates and registers the provided-buffer ring */
+static int uring_setup_buffers(uring_worker_t *w) {
+    size_t ring_len = URING_BUF_COUNT * sizeof(struct io_uring_buf);
+    w->buf_ring = mmap(NULL, ring_len, PROT_READ | PROT_WRITE,
+                       MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (w->buf_ring == MAP_FAILED) {
+        w->buf_ring = NULL;
+        return -1;
+    }
+
+    w->buf_base = malloc((size_t)URING_BUF_COUNT * URING_BUF_SIZE);
+    if (!w->buf_base) return -1;
+
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr    = (uint64_t)(uintptr_t)w->buf_ring;
+    reg.ring_entries = URING_BUF_COUNT;
+    reg.bgid         = URING_BGID;
+    if (syscall(__NR_io_uring_register, w->ring.ring_fd,
+                IORING_REGISTER_PBUF_RING, &reg, 1) < 0)
+        return -1;
+
+    w->buf_tail = 0;
+    for (unsigned i = 0; i < URING_BUF_COUNT; i++) uring_buf_recycle(w, i);
+    uring_buf_publish(w);
+    return 0;
+}
+
+/* uring_arm_wake - Queues a read on the handoff eventfd */
+static void uring_arm_wake(uring_worker_t *w) {
+    struct io_uring_sqe *sqe = uring_get_sqe(&w->ring);
+    if (!sqe) return;
+    sqe->opcode    = IORING_OP_READ;
+    sqe->fd        = w->wake_fd;
+    sqe->addr      = (uint64_t)(uintptr_t)&w->wake_val;
+    sqe->len       = sizeof(w->wake_val);
+    sqe->user_data = URING_WAKE_TAG;
+}
+
+/*
+ * uring_arm_recv - Queues a multishot recv selecting from the buffer ring.
+ * Returns: 0, or -1 if no SQE could be had (errno set); the caller must
+ * then finish the connection, since nothing in the ring refers to it.
+ */
+static int uring_arm_recv(uring_worker_t *w, conn_state_t *c) {
+    struct io_uring_sqe *sqe = uring_get_sqe(&w->ring);
+    if (!sqe) return -1;
+    sqe->opcode    = IORING_OP_RECV;
+    sqe->fd        = c->client_fd;
+    sqe->ioprio    = IORING_RECV_MULTISHOT;
+    sqe->flags     = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = URING_BGID;
+    sqe->user_data = (uint64_t)(uintptr_t)c;
+    return 0;
+}
+
+/* uring_rearm - Arms c's recv, or reports and finishes c if it cannot */
+static void uring_rearm(uring_worker_t *w, conn_state_t *c) {
+    if (uring_arm_recv(w, c) == 0) return;
+    fprintf(stderr, "[Server T%d] arm recv: %s\n", c->thread_id, strerror(errno));
+    conn_finish(c);
+}
+
+/* uring_cancel_recv - Queues a cancel of the connection's multishot recv */
+static void uring_cancel_recv(uring_worker_t *w, conn_state_t *c) {
+    struct io_uring_sqe *sqe = uring_get_sqe(&w->ring);
+    if (!sqe) {
+        /* Cannot cancel: drop rather than leave the client waiting */
+        c->dropping = 1;
+        shutdown(c->client_fd, SHUT_RDWR);
+        return;
+    }
+    sqe->opcode    = IORING_OP_ASYNC_CANCEL;
+    sqe->fd        = -1;
+    sqe->addr      = (uint64_t)(uintptr_t)c;
+    sqe->user_data = URING_CANCEL_TAG;
+    c->echo_handoff = 2;
+}
+
+/*
+ * uring_stash - Keeps echo payload that the multishot recv delivered
+ * before the handoff, so the echo thread can send it back.
+ * Returns: 0 on success, -1 if out of memory.
+ */
+static int uring_stash(conn_state_t *c, const char *data, size_t len) {
+    if (len == 0) return 0;
+    char *p = realloc(c->echo_backlog, c->echo_backlog_len + len);
+    if (!p) {
+        perror("realloc echo backlog");
+        return -1;
+    }
+    memcpy(p + c->echo_backlog_len, data, len);
+    c->echo_backlog      = p;
+    c->echo_backlog_len += len;
+    return 0;
+}
+
+/*
+ * uring_echo_thread - Serves an echo session handed off by a worker:
+ * pins, allocates recv_buf on its own node, echoes the backlog the
+ * multishot recv had already read, then runs the blocking echo loop.
+ */
+static void *uring_echo_thread(void *arg) {
+    conn_state_t *c = (conn_state_t *)arg;
+    conn_pin(c);
+    if (conn_start(c, 1) == 0) {
+        int one = 1;
+        setsockopt(c->client_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        if (c->echo_backlog_len > 0) {
+            conn_account(c, c->echo_backlog, c->echo_backlog_len);
+            if (send_all(c->client_fd, c->echo_backlog, c->echo_backlog_len, 0) < 0) {
+                conn_finish(c);
+                return NULL;
+            }
+        }
+        conn_echo_loop(c);
+    }
+    conn_finish(c);
+    return NULL;
+}
+
+/*
+ * uring_consume - Accounts one received buffer to a connection.
+ * The config_t handshake shares the byte stream with the payload, so
+ * its bytes are peeled off the front before payload is counted. After
+ * an echo config the payload is stashed for the echo thread instead.
+ */
+static void uring_consume(conn_state_t *c, const char *data, size_t len) {
+    if (c->dropping) return;
+
+    if (c->cfg_received < sizeof(c->config)) {
+        size_t need = sizeof(c->config) - c->cfg_received;
+        size_t take = len < need ? len : need;
+        memcpy((char *)&c->config + c->cfg_received, data, take);
+        c->cfg_received += take;
+        data += take;
+        len  -= take;
+        if (c->cfg_received < sizeof(c->config)) return;
+        if (c->config.echo) {
+            c->echo_handoff = 1;    /* worker cancels the recv, then hands off */
+        } else if (conn_start(c, 0) < 0) {
+            /* Let the pending multishot recv terminate with EOF */
+            c->dropping = 1;
+            shutdown(c->client_fd, SHUT_RDWR);
+            return;
+        }
+    }
+    if (c->echo_handoff) {
+        if (uring_stash(c, data, len) < 0) {
+            c->dropping = 1;
+            shutdown(c->client_fd, SHUT_RDWR);
+        }
+        return;
+    }
+    conn_account(c, data, len);
+}
+
+/*
+ * uring_worker - Completion loop for one io_uring worker.
+ * Every iteration submits all queued SQEs, waits for completions, and
+ * processes the whole CQ batch before republishing recycled buffers.
+ */
+static void *uring_worker(void *arg) {
+    uring_worker_t *w = (uring_worker_t *)arg;
+    uring_t        *r = &w->ring;
+
+    pin_thread_to_cpu(cpu_policy_cpu(&g_pin, w->worker_id));
+    uring_arm_wake(w);
+
+    while (g_running && !w->stop) {
+        if (uring_enter(r, 1, URING_WAIT_MS) < 0 &&
+            errno != ETIME && errno != EINTR) {
+            perror("io_uring_enter");
+            break;
+        }
+
+        unsigned head = *r->cq_head;
+        unsigned tail = __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail; head++) {
+            struct io_uring_cqe *cqe = &r->cqes[head & *r->cq_mask];
+
+            if (cqe->user_data == URING_WAKE_TAG) {
+                pthread_mutex_lock(&w->lock);
+                conn_state_t *list = w->pending;
+                w->pending = NULL;
+                pthread_mutex_unlock(&w->lock);
+                while (list) {
+                    conn_state_t *c = list;
+                    list = c->next_ready;
+                    uring_rearm(w, c);
+                }
+                uring_arm_wake(w);
+                continue;
+            }
+            if (cqe->user_data == URING_CANCEL_TAG) continue;
+
+            conn_state_t *c = (conn_state_t *)(uintptr_t)cqe->user_data;
+            if (cqe->flags & IORING_CQE_F_BUFFER) {
+                unsigned bid = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+                if (cqe->res > 0)
+                    uring_consume(c, w->buf_base + (size_t)bid * URING_BUF_SIZE,
+                                  (size_t)cqe->res);
+                uring_buf_recycle(w, bid);
+            }
+
+            if (!(cqe->flags & IORING_CQE_F_MORE)) {
+                /*
+                 * Multishot ended: an echo session moves to its thread
+                 * (nothing of it is left in the ring), EOF/error closes,
+                 * ENOBUFS re-arms
+                 */
+                if (c->echo_handoff && !c->dropping) {
+                    if (conn_spawn(c, uring_echo_thread) < 0) conn_finish(c);
+                } else if (cqe->res > 0 || cqe->res == -ENOBUFS) {
+                    uring_rearm(w, c);
+                } else {
+                    if (cqe->res < 0 && cqe->res != -ECONNRESET)
+                        fprintf(stderr, "[Server T%d] recv: %s\n",
+                                c->thread_id, strerror(-cqe->res));
+                    conn_finish(c);
+                }
+            } else if (c->echo_handoff == 1 && !c->dropping) {
+                /* Still armed: stop it; its final CQE triggers the handoff */
+                uring_cancel_recv(w, c);
+            }
+        }
+        __atomic_store_n(r->cq_head, head, __ATOMIC_RELEASE);
+        uring_buf_publish(w);
+    }
+    return NULL;
+}
+
+/*
+ * release_uring_workers - Stops and joins the first 'started' workers,
+ * then tears down whatever each worker had set up: ring (and with it
+ * the registered buffer ring), buffer memory and handoff eventfd.
+ * Used both to unwind a partial start and on shutdown.
+ */
+static void release_uring_workers(uring_worker_t *workers, int count, int started) {
+    for (int i = 0; i < started; i++) workers[i].stop = 1;
+    for (int i = 0; i < started; i++) pthread_join(workers[i].tid, NULL);
+    for (int i = 0; i < count; i++) {
+        uring_worker_t *w = &workers[i];
+        if (w->ring.ring_ptr) uring_exit(&w->ring);
+        if (w->buf_ring) munmap(w->buf_ring, URING_BUF_COUNT * sizeof(struct io_uring_buf));
+        free(w->buf_base);
+        if (w->wake_fd >= 0) {
+            close(w->wake_fd);
+            pthread_mutex_destroy(&w->lock);
+        }
+    }
+    free(workers);
+}
+
+/*
+ * start_uring_workers - Creates 'count' rings with buffer rings and
+ * starts their worker threads.
+ * Returns: Array of uring_worker_t, or NULL if io_uring is unavailable
+ * (everything set up so far is released).
+ */
+static void *start_uring_workers(int count) {
+    uring_worker_t *workers = calloc(count, sizeof(uring_worker_t));
+    if (!workers) { perror("calloc workers"); return NULL; }
+
+    for (int i = 0; i < count; i++) workers[i].wake_fd = -1;
+    for (int i = 0; i < count; i++) {
+        uring_worker_t *w = &workers[i];
+        w->worker_id = i;
+        if (uring_init(&w->ring, URING_ENTRIES) < 0) {
+            perror("io_uring_setup");
+            memset(&w->ring, 0, sizeof(w->ring));
+            release_uring_workers(workers, count, 0);
+            return NULL;
+        }
+        if (!(w->ring.features & IORING_FEAT_EXT_ARG)) {
+            /* uring_enter() timeouts need IORING_FEAT_EXT_ARG (>= 5.11) */
+            fprintf(stderr, "[Server] io_uring lacks IORING_FEAT_EXT_ARG\n");
+            release_uring_workers(workers, count, 0);
+            return NULL;
+        }
+        if (uring_setup_buffers(w) < 0) {
+            perror("io_uring provided buffers");
+            release_uring_workers(workers, count, 0);
+            return NULL;
+        }
+        w->wake_fd = eventfd(0, EFD_CLOEXEC);
+        if (w->wake_fd < 0) {
+            perror("eventfd");
+            release_uring_workers(workers, count, 0);
+            return NULL;
+        }
+        pthread_mutex_init(&w->lock, NULL);
+    }
+    for (int i = 0; i < count; i++) {
+        if (pthread_create(&workers[i].tid, NULL, uring_worker, &workers[i]) != 0) {
+            perror("pthread_create");
+            release_uring_workers(workers, count, i);
+            return NULL;
+        }
+    }
+    printf("[Server] io_uring engine: %d workers, %d x %d B provided buffers each\n",
+           count, URING_BUF_COUNT, URING_BUF_SIZE);
+    return workers;
+}
+
+/* uring_add_client - Queues an accepted socket for a worker to arm */
+static int uring_add_client(void *pool, int worker, conn_state_t *c) {
+    uring_worker_t *w = &((uring_worker_t *)pool)[worker];
+
+    pthread_mutex_lock(&w->lock);
+    c->next_ready = w->pending;
+    w->pending    = c;
+    pthread_mutex_unlock(&w->lock);
+
+    uint64_t one = 1;
+    if (write(w->wake_fd, &one, sizeof(one)) != sizeof(one))
+        perror("write eventfd");
+    return 0;
+}
+
+/* stop_uring_workers - Joins the workers once g_running is cleared */
+static void stop_uring_workers(void *pool, int count) {
+    release_uring_workers((uring_worker_t *)pool, count, count);
+}
+
+const recv_engine_t recv_uring = {
+    .name       = "uring",
+    .start      = start_uring_workers,
+    .add_client = uring_add_client,
+    .stop       = stop_uring_workers,
+};
@@ -0,0 +1,136 @@
+/*
+ * MT25062_Server_Zerocopy.c
+ * TCP_ZEROCOPY_RECEIVE Engine (Receiver Side)
+ * Roll No: MT25062
+ *
+ * Receive engine -m zerocopy: one thread per client using
+ * TCP_ZEROCOPY_RECEIVE. Payload pages are remapped into an mmap()ed
+ * window of the socket instead of copied; only sub-page remainders
+ * use recv().
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/mman.h>
+#include <poll.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <errno.h>
+
+#include "MT25062_Netbench.h"
+
+/* ========================= Constants ================================= */
+#define ZCRX_MAP_SIZE      (512 * 1024) /* mmap() window per connection     */
+#define ZCRX_POLL_MS       500   /* Idle wait when the receive queue is empty */
+
+/* ========================= Zero-Copy Receive Engine ================== */
+/*
+ * handle_client_zerocopy - Thread function using TCP_ZEROCOPY_RECEIVE.
+ *
+ * The socket is mmap()ed once. Each getsockopt(TCP_ZEROCOPY_RECEIVE)
+ * remaps whole payload pages from the receive queue into that window
+ * (replacing the previous mapping) instead of copying them. Bytes that
+ * cannot be mapped -- headers, sub-page tails -- are reported through
+ * recv_skip_hint and read with recv() into recv_buf. If the socket
+ * cannot be mapped at all the handler degrades to plain recv().
+ */
+static void *handle_client_zerocopy(void *arg) {
+    conn_state_t *c = (conn_state_t *)arg;
+
+    /* Pin before allocating, so -N places recv_buf on this core's node */
+    if (conn_recv_config(c) < 0) {
+        conn_finish(c);
+        return NULL;
+    }
+    conn_pin(c);
+    if (conn_start(c, 1) < 0) {
+        conn_finish(c);
+        return NULL;
+    }
+    if (c->config.echo) {
+        conn_echo_loop(c);
+        conn_finish(c);
+        return NULL;
+    }
+
+    int    msg_size = c->config.msg_size;
+    char  *map      = mmap(NULL, ZCRX_MAP_SIZE, PROT_READ, MAP_SHARED, c->client_fd, 0);
+    if (map == MAP_FAILED) {
+        perror("mmap socket");
+        fprintf(stderr, "[Server T%d] Zero-copy receive unavailable, using recv()\n",
+                c->thread_id);
+    }
+
+    long long mapped_bytes = 0;
+    long long copied_bytes = 0;
+
+    while (g_running) {
+        if (map == MAP_FAILED) {
+            ssize_t bytes = recv(c->client_fd, c->recv_buf, msg_size, 0);
+            if (bytes <= 0) break;
+            copied_bytes += bytes;
+            conn_account(c, c->recv_buf, (size_t)bytes);
+            continue;
+        }
+
+        struct tcp_zerocopy_receive zc;
+        socklen_t zc_len = sizeof(zc);
+        memset(&zc, 0, sizeof(zc));
+        zc.address = (uint64_t)(uintptr_t)map;
+        zc.length  = ZCRX_MAP_SIZE;
+
+        if (getsockopt(c->client_fd, IPPROTO_TCP, TCP_ZEROCOPY_RECEIVE, &zc, &zc_len) < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EIO) break;  /* FIN with an empty receive queue */
+            perror("getsockopt TCP_ZEROCOPY_RECEIVE");
+            munmap(map, ZCRX_MAP_SIZE);
+            map = MAP_FAILED;
+            continue;
+        }
+
+        /* Pages now mapped at 'map': received without a copy */
+        mapped_bytes += zc.length;
+        conn_account(c, map, zc.length);
+
+        if (zc.recv_skip_hint) {
+            /* Unaligned remainder: fall back to a copying recv() */
+            size_t  want  = zc.recv_skip_hint < (uint32_t)msg_size
+                          ? zc.recv_skip_hint : (uint32_t)msg_size;
+            ssize_t bytes = recv(c->client_fd, c->recv_buf, want, 0);
+            if (bytes <= 0) break;
+            copied_bytes += bytes;
+            conn_account(c, c->recv_buf, (size_t)bytes);
+        } else if (zc.length == 0) {
+            /* Queue empty: wait for data, then peek to tell data from FIN */
+            struct pollfd pfd = { .fd = c->client_fd, .events = POLLIN };
+            if (poll(&pfd, 1, ZCRX_POLL_MS) > 0) {
+                char peek;
+                if (recv(c->client_fd, &peek, 1, MSG_PEEK | MSG_DONTWAIT) == 0) break;
+            }
+        }
+    }
+
+    printf("[Server T%d] Zero-copy receive: %lld bytes mapped, %lld bytes copied\n",
+           c->thread_id, mapped_bytes, copied_bytes);
+
+    if (map != MAP_FAILED) munmap(map, ZCRX_MAP_SIZE);
+    conn_finish(c);
+    return NULL;
+}
+
+/* zerocopy_add_client - Serves the connection on its own detached thread */
+static int zerocopy_add_client(void *pool, int worker, conn_state_t *c) {
+    (void)pool;
+    (void)worker;
+    return conn_spawn(c, handle_client_zerocopy);
+}
+
+const recv_engine_t recv_zerocopy = {
+    .name       = "zerocopy",
+    .start      = NULL,
+    .add_client = zerocopy_add_client,
+    .stop       = NULL,
+};